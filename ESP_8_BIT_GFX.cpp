@@ -57,12 +57,21 @@ SOFTWARE.
 */
 
 #include "ESP_8_BIT_GFX.h"
+#include "ESP_8_BIT_palette.h"
+#include "ESP_8_BIT_pixelops.h"
+
+// Classic built-in font of Adafruit_GFX
+#include "glcdfont.c"
 
 static const char *TAG = "ESP_8_BIT_GFX";
 
+// Full resolution, reduced in begin() if the frame buffer is smaller
 static const int16_t MAX_Y = 239;
 static const int16_t MAX_X = 255;
 
+// Largest radius drawn by fillRoundSpans(), bigger than any frame buffer
+static const int16_t MAX_SPAN_RADIUS = 383;
+
 /*
  * @brief Expose Adafruit GFX API for ESP_8_BIT composite video generator
  */
@@ -88,6 +97,19 @@ ESP_8_BIT_GFX::ESP_8_BIT_GFX(bool ntsc, uint8_t colorDepth)
 
   // Default behavior is not to copy buffer upon swap
   copyAfterSwap = false;
+  _bitsPerPixel = 8;
+  _lines = NULL;
+  bindPixelWriter();
+
+  // Glyph cache starts empty
+  memset(_glyphBuckets, 0, sizeof(_glyphBuckets));
+  _glyphNewest = NULL;
+  _glyphOldest = NULL;
+  _glyphBytes = 0;
+  _glyphCacheSize = 8192;
+
+  // Bitmaps convert color the same way as pixels unless asked to dither
+  _bitmapDither = false;
 
   // Initialize performance tracking state
   _perfStart = 0;
@@ -101,6 +123,14 @@ ESP_8_BIT_GFX::ESP_8_BIT_GFX(bool ntsc, uint8_t colorDepth)
 void ESP_8_BIT_GFX::begin()
 {
   _pVideo->begin();
+
+  // Report frame buffer size, which may be smaller than full resolution
+  // per ESP_8_BIT_composite::setResolution()
+  WIDTH = _pVideo->getWidth();
+  HEIGHT = _pVideo->getHeight();
+  _bitsPerPixel = _pVideo->getBitsPerPixel();
+  _lines = _pVideo->getFrameBufferLines();
+  setRotation(getRotation());
 }
 
 /*
@@ -148,7 +178,7 @@ uint32_t ESP_8_BIT_GFX::perfData()
 void ESP_8_BIT_GFX::waitForFrame()
 {
   // Track the old lines array in case we need to copy after swap
-  uint8_t** oldLineArray = _pVideo->getFrameBufferLines();
+  uint8_t** oldLineArray = _lines;
   // Values to track time spent waiting for swap
   uint32_t waitStart = xthal_get_ccount();
   uint32_t waitEnd;
@@ -169,15 +199,18 @@ void ESP_8_BIT_GFX::waitForFrame()
   // Wait for swap of front and back buffer
   _pVideo->waitForFrame();
 
-  if (copyAfterSwap)
+  uint8_t** newLineArray = _pVideo->getFrameBufferLines();
+  _lines = newLineArray;
+  // Single buffered interlaced frame buffer has nothing to copy
+  if (copyAfterSwap && newLineArray != oldLineArray)
   {
-    uint8_t** newLineArray = _pVideo->getFrameBufferLines();
-
     // This must be kept in sync with how frame buffer memory
     // is allocated in ESP_8_BIT_composite::frameBufferAlloc()
-    for (uint8_t chunk = 0; chunk < 15; chunk++)
+    int lineBytes = WIDTH*_bitsPerPixel/8;
+    int chunkLines = 4096/lineBytes;
+    for (int chunkStart = 0; chunkStart < HEIGHT; chunkStart += chunkLines)
     {
-      memcpy(newLineArray[chunk*16], oldLineArray[chunk*16], 256*16);
+      memcpy(newLineArray[chunkStart], oldLineArray[chunkStart], lineBytes*min(chunkLines, HEIGHT-chunkStart));
     }
   }
 
@@ -198,6 +231,58 @@ void ESP_8_BIT_GFX::waitForFrame()
   }
 }
 
+/*
+ * @brief Send one band of the frame to screen, honoring copyAfterSwap
+ */
+void ESP_8_BIT_GFX::presentBand(int band)
+{
+  int bandLines = _pVideo->getBandLines();
+  int first = band*bandLines;
+  int lineBytes = WIDTH*_bitsPerPixel/8;
+  int chunkLines = 4096/lineBytes;
+  uint8_t* presented[ESP_8_BIT_MAX_WINDOW_LINES/(4096/ESP_8_BIT_MAX_LINE_PIXELS) + 1];
+
+  if (band < 0 || first + bandLines > HEIGHT)
+  {
+    // Not a band of this frame buffer, let presentBand() report it
+    _pVideo->presentBand(band);
+    return;
+  }
+
+  // Each frame buffer chunk is contiguous, see
+  // ESP_8_BIT_composite::frameBufferAlloc()
+  for (int chunkStart = first; chunkStart < first + bandLines; chunkStart += chunkLines)
+  {
+    presented[(chunkStart - first)/chunkLines] = _lines[chunkStart];
+  }
+
+  _pVideo->presentBand(band);
+
+  // A whole buffer swap may have happened while the band was pending
+  _lines = _pVideo->getFrameBufferLines();
+
+  if (copyAfterSwap)
+  {
+    for (int chunkStart = first; chunkStart < first + bandLines; chunkStart += chunkLines)
+    {
+      uint8_t* src = presented[(chunkStart - first)/chunkLines];
+      if (_lines[chunkStart] != src)
+      {
+        memcpy(_lines[chunkStart], src, lineBytes*min(chunkLines, first + bandLines - chunkStart));
+      }
+    }
+  }
+}
+
+/*
+ * @brief Send the frame to screen right away, tearing allowed
+ */
+void ESP_8_BIT_GFX::presentImmediate()
+{
+  _pVideo->presentImmediate();
+  _lines = _pVideo->getFrameBufferLines();
+}
+
 /*
  * @brief Fraction of time in waitForFrame() in percent of percent.
  * @return Number range from 0 to 10000. Higher values indicate more time
@@ -230,12 +315,11 @@ uint32_t ESP_8_BIT_GFX::newPerformanceTrackingSession()
   return perfData();
 }
 
-/*
- * @brief Utility to convert from 16-bit RGB565 color to 8-bit RGB332 color
- */
-uint8_t ESP_8_BIT_GFX::convertRGB565toRGB332(uint16_t color)
+// Per pixel helpers, inlined into the pixel writers below
+
+// Extract most significant 3 red, 3 green and 2 blue bits.
+static inline uint8_t rgb565_to_rgb332(uint16_t color)
 {
-  // Extract most significant 3 red, 3 green and 2 blue bits.
   return (uint8_t)(
         (color & 0xE000) >> 8 |
         (color & 0x0700) >> 6 |
@@ -243,6 +327,43 @@ uint8_t ESP_8_BIT_GFX::convertRGB565toRGB332(uint16_t color)
       );
 }
 
+// RGB332 color per constructor colorDepth, decided at compile time
+template<uint8_t COLOR_DEPTH> static inline uint8_t color8_of(uint16_t color)
+{
+  return 16 == COLOR_DEPTH ? rgb565_to_rgb332(color) : (uint8_t)color;
+}
+
+// Luminance of an RGB332 color in as many levels as bits per pixel allow
+static inline uint8_t gray_of(uint8_t color8, uint8_t bits)
+{
+  // 0.299R + 0.587G + 0.114B scaled to 0-255000
+  uint32_t luma = (color8 >> 5)*10892 + ((color8 >> 2) & 7)*21384 + (color8 & 3)*9690;
+  return (luma/1000) >> (8 - bits);
+}
+
+// Set one pixel of a 1 or 2 bits per pixel frame buffer line
+template<uint8_t BITS> static inline void put_gray(uint8_t* line, int16_t x, uint8_t gray)
+{
+  if (1 == BITS)
+  {
+    uint8_t mask = 0x80 >> (x & 7);
+    line[x >> 3] = gray ? (line[x >> 3] | mask) : (line[x >> 3] & ~mask);
+  }
+  else
+  {
+    int shift = 6 - 2*(x & 3);
+    line[x >> 2] = (line[x >> 2] & ~(3 << shift)) | (gray << shift);
+  }
+}
+
+/*
+ * @brief Utility to convert from 16-bit RGB565 color to 8-bit RGB332 color
+ */
+uint8_t ESP_8_BIT_GFX::convertRGB565toRGB332(uint16_t color)
+{
+  return rgb565_to_rgb332(color);
+}
+
 /*
  * @brief Retrieve color to use depending on _colorDepth
  */
@@ -268,49 +389,56 @@ uint8_t ESP_8_BIT_GFX::getColor8(uint16_t color)
 }
 
 /*
- * @brief Clamp X coordinate value within valid range
+ * @brief Gray level of a color for monochrome frame buffers: luminance of
+ * its RGB332 value, in as many levels as bits per pixel allow
  */
-int16_t ESP_8_BIT_GFX::clampX(int16_t inputX)
+uint8_t ESP_8_BIT_GFX::getGray(uint16_t color)
 {
-  if (inputX < 0) {
-    ESP_LOGV(TAG, "Clamping X to 0");
-    return 0;
-  }
+  return gray_of(getColor8(color), _bitsPerPixel);
+}
 
-  if (inputX > MAX_X) {
-    ESP_LOGV(TAG, "Clamping X to 255");
-    return MAX_X;
-  }
+/*
+ * @brief Byte filled with one gray level, for monochrome frame buffers
+ */
+uint8_t ESP_8_BIT_GFX::grayPattern(uint8_t gray)
+{
+  return 1 == _bitsPerPixel ? (gray ? 0xFF : 0x00) : gray*0x55;
+}
 
-  return inputX;
+/*
+ * @brief Value written by spans: RGB332 color, or gray level in monochrome
+ * mode
+ */
+uint8_t ESP_8_BIT_GFX::spanValue(uint16_t color)
+{
+  return 8 == _bitsPerPixel ? getColor8(color) : getGray(color);
 }
 
 /*
- * @brief Clamp Y coordinate value within valid range
+ * @brief Set one pixel of a monochrome frame buffer line
  */
-int16_t ESP_8_BIT_GFX::clampY(int16_t inputY)
+void ESP_8_BIT_GFX::putGray(uint8_t* line, int16_t x, uint8_t gray)
 {
-  if (inputY < 0) {
-    ESP_LOGV(TAG, "Clamping Y to 0");
-    return 0;
+  if (1 == _bitsPerPixel)
+  {
+    put_gray<1>(line, x, gray);
   }
-
-  if (inputY > MAX_Y) {
-    ESP_LOGV(TAG, "Clamping Y to 239");
-    return MAX_Y;
+  else
+  {
+    put_gray<2>(line, x, gray);
   }
-
-  return inputY;
 }
 
 /*
- * @brief Required Adafruit_GFX override to put a pixel on screen
+ * @brief Put a pixel on screen, with rotation, color depth and frame
+ * buffer format fixed at compile time
  */
-void ESP_8_BIT_GFX::drawPixel(int16_t x, int16_t y, uint16_t color)
+template<uint8_t ROTATION, uint8_t COLOR_DEPTH, uint8_t BITS>
+void ESP_8_BIT_GFX::writePixelAs(int16_t x, int16_t y, uint16_t color)
 {
   // Account for screen rotation. Copied from Adafruit_GFX.cpp
   int16_t t;
-  switch (rotation) {
+  switch (ROTATION) {
   case 1:
     t = x;
     x = WIDTH - 1 - y;
@@ -327,148 +455,2386 @@ void ESP_8_BIT_GFX::drawPixel(int16_t x, int16_t y, uint16_t color)
     break;
   }
 
-  if (x < 0 || x > MAX_X ||
-      y < 0 || y > MAX_Y )
+  // Negative coordinates wrap around to large unsigned values
+  if ((uint16_t)x >= (uint16_t)WIDTH || (uint16_t)y >= (uint16_t)HEIGHT)
   {
     // This pixel is off screen, nothing to draw.
     return;
   }
 
-  startWrite();
-  _pVideo->getFrameBufferLines()[y][x] = getColor8(color);
-  endWrite();
+  uint8_t color8 = color8_of<COLOR_DEPTH>(color);
+  if (8 == BITS)
+  {
+    _lines[y][x] = color8;
+  }
+  else
+  {
+    put_gray<BITS>(_lines[y], x, gray_of(color8, BITS));
+  }
 }
 
-/**************************************************************************/
-/*!
-   @brief    Draw a perfectly vertical line, optimized for ESP_8_BIT
-    @param    x   Top-most x coordinate
-    @param    y   Top-most y coordinate
-    @param    h   Height in pixels
-   @param    color Color to fill with.
-*/
-/**************************************************************************/
-void ESP_8_BIT_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+#define ESP_8_BIT_PIXEL_WRITERS(depth, bits) { \
+    &ESP_8_BIT_GFX::writePixelAs<0, depth, bits>, \
+    &ESP_8_BIT_GFX::writePixelAs<1, depth, bits>, \
+    &ESP_8_BIT_GFX::writePixelAs<2, depth, bits>, \
+    &ESP_8_BIT_GFX::writePixelAs<3, depth, bits> }
+
+/*
+ * @brief Pick the pixel writer for current rotation, color depth and
+ * frame buffer format
+ */
+void ESP_8_BIT_GFX::bindPixelWriter()
 {
-  // Call ESP_8_BIT optimized fillRect with width of one
-  fillRect(x, y, 1, h, color);
+  static const pixel_writer writers[3][2][4] = {
+    { ESP_8_BIT_PIXEL_WRITERS(8, 8), ESP_8_BIT_PIXEL_WRITERS(16, 8) },
+    { ESP_8_BIT_PIXEL_WRITERS(8, 1), ESP_8_BIT_PIXEL_WRITERS(16, 1) },
+    { ESP_8_BIT_PIXEL_WRITERS(8, 2), ESP_8_BIT_PIXEL_WRITERS(16, 2) }
+  };
+  int format = 8 == _bitsPerPixel ? 0 : _bitsPerPixel;
+  _pixelWriter = writers[format][16 == _colorDepth][rotation & 3];
 }
 
-/**************************************************************************/
-/*!
-   @brief    Draw a perfectly horizontal line, optimized for ESP_8_BIT
-    @param    x   Left-most x coordinate
-    @param    y   Left-most y coordinate
-    @param    w   Width in pixels
-   @param    color Color to fill with
-*/
-/**************************************************************************/
+/*
+ * @brief Adafruit_GFX override to also rebind the pixel writer
+ */
+void ESP_8_BIT_GFX::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  bindPixelWriter();
+}
 
-void ESP_8_BIT_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+/*
+ * @brief Required Adafruit_GFX override to put a pixel on screen
+ */
+void ESP_8_BIT_GFX::drawPixel(int16_t x, int16_t y, uint16_t color)
 {
-  // Call ESP_8_BIT optimized fillRect with height of one
-  fillRect(x, y, w, 1, color);
+  (this->*_pixelWriter)(x, y, color);
 }
 
-/**************************************************************************/
-/*!
-   @brief    Fill a rectangle completely with one color, optimized for ESP_8_BIT
-    @param    x   Top left corner x coordinate
-    @param    y   Top left corner y coordinate
-    @param    w   Width in pixels
-    @param    h   Height in pixels
-   @param    color Color to fill with
-*/
-/**************************************************************************/
-void ESP_8_BIT_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+/*
+ * @brief Adafruit_GFX override to put a pixel on screen within a
+ * startWrite()/endWrite() transaction
+ */
+void ESP_8_BIT_GFX::writePixel(int16_t x, int16_t y, uint16_t color)
+{
+  (this->*_pixelWriter)(x, y, color);
+}
+
+/*
+ * @brief Fill w pixels of a frame buffer line starting at x, already
+ * clipped. Value is RGB332 color, or gray level in monochrome mode.
+ */
+void ESP_8_BIT_GFX::fillSpan(uint8_t* line, int16_t x, int16_t w, uint8_t value)
 {
-  if (h < 1)
+  if (8 == _bitsPerPixel)
   {
-    // Don't draw anything for zero or negative height
+    memset(line + x, value, w);
     return;
   }
 
-  if (w < 1)
+  // Partial bytes pixel by pixel, whole bytes in between by memset
+  int16_t pixelsPerByte = 8/_bitsPerPixel;
+  int16_t head = min((int16_t)((pixelsPerByte - x % pixelsPerByte) % pixelsPerByte), w);
+  int16_t bytes = (w - head)/pixelsPerByte;
+  int16_t end = x + w;
+  for (; x < end && head > 0; x++, head--)
+  {
+    putGray(line, x, value);
+  }
+  memset(line + x/pixelsPerByte, grayPattern(value), bytes);
+  for (x += bytes*pixelsPerByte; x < end; x++)
+  {
+    putGray(line, x, value);
+  }
+}
+
+/*
+ * @brief Fill a rectangle given in frame buffer coordinates, clipped to
+ * the frame buffer. Value is from spanValue().
+ */
+void ESP_8_BIT_GFX::fillFrameRect(int x, int y, int w, int h, uint8_t value)
+{
+  int x1 = min(x + w, (int)WIDTH);
+  int y1 = min(y + h, (int)HEIGHT);
+  x = max(x, 0);
+  y = max(y, 0);
+  if (x >= x1 || y >= y1)
   {
-    // Don't draw anything for zero or negative width
+    // Nothing left on screen to draw.
     return;
   }
 
-  // Account for screen rotation.
-  int16_t t;
+  if (8 == _bitsPerPixel && x + 1 == x1)
+  {
+    // Vertical line, one byte per line
+    for (; y < y1; y++)
+    {
+      _lines[y][x] = value;
+    }
+    return;
+  }
+
+  for (; y < y1; y++)
+  {
+    fillSpan(_lines[y], x, x1 - x, value);
+  }
+}
+
+/*
+ * @brief Fill a rectangle given in screen coordinates, accounting for
+ * screen rotation with the same pixels as drawPixel()
+ */
+void ESP_8_BIT_GFX::fillScreenRect(int x, int y, int w, int h, uint8_t value)
+{
   switch (rotation) {
   case 1:
-    t = x;
-    x = WIDTH - 1 - y - h;
-    y = t;
-    // Swap width and height
-    t = w;
-    w = h;
-    h = t;
+    fillFrameRect(WIDTH - y - h, x, h, w, value);
     break;
   case 2:
-    x = WIDTH - 1 - x - w;
-    y = HEIGHT - 1 - y - h;
+    fillFrameRect(WIDTH - x - w, HEIGHT - y - h, w, h, value);
     break;
   case 3:
-    t = x;
-    x = y;
-    y = HEIGHT - 1 - t - w;
-    // Swap width and height
-    t = w;
-    w = h;
-    h = t;
+    fillFrameRect(y, HEIGHT - x - w, h, w, value);
+    break;
+  default:
+    fillFrameRect(x, y, w, h, value);
     break;
   }
+}
 
-  if (x+w < 0 || x > MAX_X)
+/*
+ * @brief Adafruit_GFX override to fill a rectangle within a
+ * startWrite()/endWrite() transaction, straight into the back buffer
+ */
+void ESP_8_BIT_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if (w < 1 || h < 1)
   {
-    // This rectangle is off screen left or right, nothing to draw.
+    // Don't draw anything for zero or negative size
     return;
   }
 
-  if (y+h < 0 || y > MAX_Y )
+  fillScreenRect(x, y, w, h, spanValue(color));
+}
+
+/*
+ * @brief Adafruit_GFX overrides for lines within a transaction
+ */
+void ESP_8_BIT_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  writeFillRect(x, y, 1, h, color);
+}
+
+void ESP_8_BIT_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  writeFillRect(x, y, w, 1, color);
+}
+
+/*
+ * @brief Adafruit_GFX override to draw a line within a transaction. Same
+ * pixels as the Adafruit_GFX Bresenham loop, but the segment is clipped
+ * to the screen up front and drawn as runs of pixels sharing a row or
+ * column, each found with one division.
+ */
+void ESP_8_BIT_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  // Step along the major axis a, the minor axis b changes by bstep
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  int a0 = steep ? y0 : x0;
+  int b0 = steep ? x0 : y0;
+  int a1 = steep ? y1 : x1;
+  int b1 = steep ? x1 : y1;
+  if (a0 > a1)
   {
-    // This rectangle is off screen top or bottom, nothing to draw.
-    return;
+    int t = a0; a0 = a1; a1 = t;
+    t = b0; b0 = b1; b1 = t;
   }
+  int da = a1 - a0;
+  int db = abs(b1 - b0);
+  int bstep = b0 < b1 ? 1 : -1;
+  int err0 = da/2;
+  int aSize = steep ? _height : _width;
+  int bSize = steep ? _width : _height;
 
-  int16_t clampedX = clampX(x);
-  int16_t clampedXW = clampX(x+w-1);
-  int16_t fillWidth = clampedXW-clampedX+1;
+  int a = a0;
+  int b = b0;
+  int aEnd = a1;
+  int err = err0;
+  if (a0 < 0 || a1 >= aSize || min(b0, b1) < 0 || max(b0, b1) >= bSize)
+  {
+    // Steps i from 0 to da, before step i the minor axis has moved
+    // k(i) = (i*db - err0 + da - 1)/da times. Clip i to where a and b are
+    // both on screen.
+    int64_t iStart = max(0, -a0);
+    int64_t iEnd = min(da, aSize - 1 - a0);
+    int kLow = bstep > 0 ? -b0 : b0 - (bSize - 1);
+    int kHigh = bstep > 0 ? bSize - 1 - b0 : b0;
+    if (kHigh < 0 || (0 == db && kLow > 0))
+    {
+      // Line is entirely above, below, left or right of screen.
+      return;
+    }
+    if (db > 0)
+    {
+      if (kLow > 0)
+      {
+        iStart = max(iStart, ((int64_t)kLow*da + err0 - da + db)/db);
+      }
+      iEnd = min(iEnd, ((int64_t)kHigh*da + err0)/db);
+    }
+    if (iStart > iEnd)
+    {
+      // Line misses the screen.
+      return;
+    }
 
-  int16_t clampedY = clampY(y);
-  int16_t clampedYH = clampY(y+h-1)+1;
+    int k = (int)((iStart*db - err0 + da - 1)/da);
+    err = (int)(err0 - iStart*db + (int64_t)k*da);
+    a = a0 + iStart;
+    b = b0 + bstep*k;
+    aEnd = a0 + iEnd;
+  }
 
   uint8_t color8 = getColor8(color);
-  uint8_t** lines = _pVideo->getFrameBufferLines();
+  uint8_t value = 8 == _bitsPerPixel ? color8 : gray_of(color8, _bitsPerPixel);
 
-  startWrite();
-  for(int16_t vertical = clampedY; vertical < clampedYH; vertical++)
+  // Frame buffer position of the first pixel, and frame buffer steps of
+  // one step along each axis, per rotation as in drawPixel()
+  static const int8_t stepX[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+  static const int8_t stepY[4][2] = {{0, 1}, {-1, 0}, {0, -1}, {1, 0}};
+  int r = rotation & 3;
+  int lx = steep ? b : a;
+  int ly = steep ? a : b;
+  int fx = r == 0 ? lx : r == 1 ? WIDTH - 1 - ly : r == 2 ? WIDTH - 1 - lx : ly;
+  int fy = r == 0 ? ly : r == 1 ? lx : r == 2 ? HEIGHT - 1 - ly : HEIGHT - 1 - lx;
+  const int8_t* major = steep ? stepY[r] : stepX[r];
+  const int8_t* minor = steep ? stepX[r] : stepY[r];
+
+  if (0 == major[1])
+  {
+    // Runs go across the frame buffer, fill them as spans
+    int sa = major[0];
+    int sb = minor[1]*bstep;
+    while (a <= aEnd)
+    {
+      // Pixels until err goes negative, when the minor axis steps
+      int n = db == 0 ? aEnd - a + 1 : err < db ? 1 : min(err/db + 1, aEnd - a + 1);
+      int start = sa > 0 ? fx : fx - n + 1;
+      if (8 == _bitsPerPixel && n < 16)
+      {
+        uint8_t* p = _lines[fy] + start;
+        for (int i = 0; i < n; i++)
+        {
+          p[i] = value;
+        }
+      }
+      else
+      {
+        fillSpan(_lines[fy], start, n, value);
+      }
+      fx += sa*n;
+      fy += sb;
+      a += n;
+      err += da - n*db;
+    }
+  }
+  else
   {
-    memset(&(lines[vertical][clampedX]), color8, fillWidth);
+    // Runs go down the frame buffer, a pixel per frame buffer line
+    int sa = major[1];
+    int sb = minor[0]*bstep;
+    while (a <= aEnd)
+    {
+      int n = db == 0 ? aEnd - a + 1 : err < db ? 1 : min(err/db + 1, aEnd - a + 1);
+      for (int i = 0; i < n; i++, fy += sa)
+      {
+        if (8 == _bitsPerPixel)
+        {
+          _lines[fy][fx] = value;
+        }
+        else
+        {
+          putGray(_lines[fy], fx, value);
+        }
+      }
+      fx += sb;
+      a += n;
+      err += da - n*db;
+    }
   }
+}
+
+/*
+ * @brief Adafruit_GFX override to draw a line, see writeLine()
+ */
+void ESP_8_BIT_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  startWrite();
+  writeLine(x0, y0, x1, y1, color);
   endWrite();
 }
 
+/*
+ * @brief Steps x0 + k*dx/dy for k = k0, k0+1, ... with one addition per
+ * step instead of one division: x is the whole part rounded down, acc the
+ * remainder in units of 1/dy.
+ */
+struct span_edge
+{
+  int x;
+  int acc;
+  int step;
+  int rem;
+  int dy;
+
+  void init(int x0, int dx, int dyIn, int k0)
+  {
+    dy = dyIn;
+    step = dx/dy;
+    rem = dx%dy;
+    if (rem < 0)
+    {
+      step--;
+      rem += dy;
+    }
+    int64_t t = (int64_t)k0*dx;
+    int64_t q = t/dy;
+    if (t%dy < 0)
+    {
+      q--;
+    }
+    x = x0 + (int)q;
+    acc = (int)(t - q*dy);
+  }
+
+  void next()
+  {
+    x += step;
+    acc += rem;
+    if (acc >= dy)
+    {
+      acc -= dy;
+      x++;
+    }
+  }
+
+  // Current value rounded up
+  int ceiling() const
+  {
+    return x + (acc != 0);
+  }
+};
+
 /**************************************************************************/
 /*!
-   @brief    Fill the screen completely with one color, optimized for ESP_8_BIT.
+   @brief    Draw a triangle with color-fill, optimized for ESP_8_BIT. Same
+             pixels as Adafruit_GFX, but edges are stepped without a
+             division per row and rows off screen are skipped.
+    @param    x0  Vertex #0 x coordinate
+    @param    y0  Vertex #0 y coordinate
+    @param    x1  Vertex #1 x coordinate
+    @param    y1  Vertex #1 y coordinate
+    @param    x2  Vertex #2 x coordinate
+    @param    y2  Vertex #2 y coordinate
     @param    color Color to fill with
 */
 /**************************************************************************/
-void ESP_8_BIT_GFX::fillScreen(uint16_t color)
+void ESP_8_BIT_GFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+  int16_t x2, int16_t y2, uint16_t color)
 {
-  uint8_t color8 = getColor8(color);
-  uint8_t** lines = _pVideo->getFrameBufferLines();
+  // Sort coordinates by Y order (y2 >= y1 >= y0)
+  int16_t t;
+  if (y0 > y1)
+  {
+    t = y0; y0 = y1; y1 = t;
+    t = x0; x0 = x1; x1 = t;
+  }
+  if (y1 > y2)
+  {
+    t = y2; y2 = y1; y1 = t;
+    t = x2; x2 = x1; x1 = t;
+  }
+  if (y0 > y1)
+  {
+    t = y0; y0 = y1; y1 = t;
+    t = x0; x0 = x1; x1 = t;
+  }
 
+  uint8_t value = spanValue(color);
   startWrite();
-  // We can't do a single memset() because it is valid for _lines to point
-  // into non-contingous pieces of memory. (Necessary when memory is
-  // fragmented and we can't get a big enough chunk of contiguous bytes.)
-  for(uint8_t y = 0; y <= MAX_Y; y++)
+  if (y0 == y2)
+  {
+    // All on same line
+    int16_t a = min(x0, min(x1, x2));
+    fillScreenRect(a, y0, max(x0, max(x1, x2)) - a + 1, 1, value);
+    endWrite();
+    return;
+  }
+
+  // Adafruit_GFX rounds edge crossings toward zero, which is rounding down
+  // for edges going right and up for edges going left. Scanline y1 belongs
+  // to the upper part only for a flat-bottomed triangle.
+  int last = y1 == y2 ? y1 : y1 - 1;
+  int yEnd = min((int)y2, _height - 1);
+  int y = max((int)y0, 0);
+  span_edge a, b;
+  bool aLeft, bLeft = x2 < x0;
+  b.init(x0, x2 - x0, y2 - y0, y - y0);
+  if (y <= last)
+  {
+    aLeft = x1 < x0;
+    a.init(x0, x1 - x0, y1 - y0, y - y0);
+    for (int end = min(last, yEnd); y <= end; y++)
+    {
+      int xa = aLeft ? a.ceiling() : a.x;
+      int xb = bLeft ? b.ceiling() : b.x;
+      fillScreenRect(min(xa, xb), y, abs(xa - xb) + 1, 1, value);
+      a.next();
+      b.next();
+    }
+  }
+  if (y <= yEnd)
   {
-    memset(lines[y], color8, 256);
+    aLeft = x2 < x1;
+    a.init(x1, x2 - x1, y2 - y1, y - y1);
+    for (; y <= yEnd; y++)
+    {
+      int xa = aLeft ? a.ceiling() : a.x;
+      int xb = bLeft ? b.ceiling() : b.x;
+      fillScreenRect(min(xa, xb), y, abs(xa - xb) + 1, 1, value);
+      a.next();
+      b.next();
+    }
   }
   endWrite();
 }
+
+/*
+ * @brief Fill a circle of radius r split apart at its center column and
+ * row: left half centered on xl, right half on xr, top half on row cy and
+ * bottom half delta - 1 rows further down. Same pixels as the
+ * Adafruit_GFX fillCircleHelper() columns, drawn as one span per frame
+ * buffer line.
+ */
+void ESP_8_BIT_GFX::fillRoundSpans(int xl, int xr, int cy, int16_t r, int16_t delta, uint8_t value)
+{
+  // Half height of the column dx away from center, walked with the
+  // Adafruit_GFX midpoint loop.
+  int16_t half[MAX_SPAN_RADIUS + 1];
+  half[0] = r;
+  for (int16_t dx = 1; dx <= r; dx++)
+  {
+    half[dx] = -1;
+  }
+  int16_t f = 1 - r;
+  int16_t ddF_x = 1;
+  int16_t ddF_y = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  int16_t px = x;
+  int16_t py = y;
+  while (x < y)
+  {
+    if (f >= 0)
+    {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+    if (x < (y + 1))
+    {
+      half[x] = max(half[x], y);
+    }
+    if (y != py)
+    {
+      half[py] = max(half[py], px);
+      py = y;
+    }
+    px = x;
+  }
+
+  if (rotation & 1)
+  {
+    // Screen columns are frame buffer lines, fill column by column
+    fillScreenRect(xl, cy - r, xr - xl + 1, 2 * r + delta, value);
+    for (int16_t dx = 1; dx <= r && half[dx] >= 0; dx++)
+    {
+      fillScreenRect(xl - dx, cy - half[dx], 1, 2 * half[dx] + delta, value);
+      fillScreenRect(xr + dx, cy - half[dx], 1, 2 * half[dx] + delta, value);
+    }
+    return;
+  }
+
+  // Columns get shorter away from center, so rows t above the top half
+  // and t below the bottom half span every column at least t high.
+  int16_t m = 0;
+  for (int16_t t = r; t > 0; t--)
+  {
+    while (m < r && half[m + 1] >= t)
+    {
+      m++;
+    }
+    fillScreenRect(xl - m, cy - t, xr - xl + 2 * m + 1, 1, value);
+    fillScreenRect(xl - m, cy + delta - 1 + t, xr - xl + 2 * m + 1, 1, value);
+  }
+  while (m < r && half[m + 1] >= 0)
+  {
+    m++;
+  }
+  fillScreenRect(xl - m, cy, xr - xl + 2 * m + 1, delta, value);
+}
+
+/**************************************************************************/
+/*!
+   @brief    Draw a circle with filled color, optimized for ESP_8_BIT. Same
+             pixels as Adafruit_GFX, drawn as one span per row.
+    @param    x0   Center-point x coordinate
+    @param    y0   Center-point y coordinate
+    @param    r   Radius of circle
+    @param    color Color to fill with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  if (r > MAX_SPAN_RADIUS)
+  {
+    // Larger than any screen, leave it to Adafruit_GFX.
+    Adafruit_GFX::fillCircle(x0, y0, r, color);
+    return;
+  }
+  if (r < 0)
+  {
+    // Don't draw anything for negative radius
+    return;
+  }
+
+  uint8_t value = spanValue(color);
+  startWrite();
+  fillRoundSpans(x0, x0, y0, r, 1, value);
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief    Draw a rounded rectangle with fill color, optimized for
+             ESP_8_BIT. Same pixels as Adafruit_GFX, drawn as one span per
+             row.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    w   Width in pixels
+    @param    h   Height in pixels
+    @param    r   Radius of corner rounding
+    @param    color Color to fill with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+  int16_t r, uint16_t color)
+{
+  int16_t max_radius = ((w < h) ? w : h) / 2; // 1/2 minor axis
+  if (r > max_radius)
+  {
+    r = max_radius;
+  }
+  if (r < 0 || r > MAX_SPAN_RADIUS)
+  {
+    // Unusual sizes, leave them to Adafruit_GFX.
+    Adafruit_GFX::fillRoundRect(x, y, w, h, r, color);
+    return;
+  }
+
+  uint8_t value = spanValue(color);
+  startWrite();
+  fillRoundSpans(x + r, x + w - r - 1, y + r, r, h - 2 * r, value);
+  endWrite();
+}
+
+/*
+ * @brief Polygon edge for fillPolygon(), from row top down to, but not
+ * including, row bottom
+ */
+struct polygon_edge
+{
+  int top;
+  int bottom;
+  int x;
+  int dx;
+  span_edge step;
+};
+
+/**************************************************************************/
+/*!
+   @brief    Fill a polygon, convex or concave, by scanline with an edge
+             table. Vertices are pixel centers. Pixels whose center is
+             inside by the even-odd rule are filled, as are pixels on a
+             left or top edge, so polygons sharing an edge do not overlap.
+    @param    points  x and y coordinates of each vertex, count pairs
+    @param    count  Number of vertices, up to MAX_POLYGON_POINTS
+    @param    color Color to fill with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::fillPolygon(const int16_t* points, uint16_t count, uint16_t color)
+{
+  if (count > MAX_POLYGON_POINTS)
+  {
+    ESP_LOGE(TAG, "Polygon has more than %d points", MAX_POLYGON_POINTS);
+    return;
+  }
+
+  // Edge table of non-horizontal edges sorted by top row
+  polygon_edge edges[MAX_POLYGON_POINTS];
+  int edgeCount = 0;
+  int bottom = INT16_MIN;
+  for (int i = 0; i < count; i++)
+  {
+    int j = i + 1 < count ? i + 1 : 0;
+    int x0 = points[2*i];
+    int y0 = points[2*i + 1];
+    int x1 = points[2*j];
+    int y1 = points[2*j + 1];
+    if (y0 == y1)
+    {
+      continue;
+    }
+    if (y0 > y1)
+    {
+      int t = x0; x0 = x1; x1 = t;
+      t = y0; y0 = y1; y1 = t;
+    }
+
+    int e = edgeCount++;
+    for (; e > 0 && edges[e - 1].top > y0; e--)
+    {
+      edges[e] = edges[e - 1];
+    }
+    edges[e].top = y0;
+    edges[e].bottom = y1;
+    edges[e].x = x0;
+    edges[e].dx = x1 - x0;
+    bottom = max(bottom, y1);
+  }
+  if (0 == edgeCount)
+  {
+    // No area to fill.
+    return;
+  }
+
+  uint8_t value = spanValue(color);
+  int active[MAX_POLYGON_POINTS];
+  int activeCount = 0;
+  int nextEdge = 0;
+  int crossings[MAX_POLYGON_POINTS];
+  int end = min(bottom, (int)_height);
+  startWrite();
+  for (int y = max(edges[0].top, 0); y < end; y++)
+  {
+    // Retire edges ending above this row, activate edges starting on or
+    // above it, stepped to this row.
+    int kept = 0;
+    for (int i = 0; i < activeCount; i++)
+    {
+      if (edges[active[i]].bottom > y)
+      {
+        active[kept++] = active[i];
+      }
+    }
+    activeCount = kept;
+    for (; nextEdge < edgeCount && edges[nextEdge].top <= y; nextEdge++)
+    {
+      polygon_edge& e = edges[nextEdge];
+      if (e.bottom > y)
+      {
+        e.step.init(e.x, e.dx, e.bottom - e.top, y - e.top);
+        active[activeCount++] = nextEdge;
+      }
+    }
+
+    // First pixel center at or right of each crossing, sorted
+    for (int i = 0; i < activeCount; i++)
+    {
+      int c = edges[active[i]].step.ceiling();
+      int k = i;
+      for (; k > 0 && crossings[k - 1] > c; k--)
+      {
+        crossings[k] = crossings[k - 1];
+      }
+      crossings[k] = c;
+      edges[active[i]].step.next();
+    }
+
+    for (int i = 0; i + 1 < activeCount; i += 2)
+    {
+      fillScreenRect(crossings[i], y, crossings[i + 1] - crossings[i], 1, value);
+    }
+  }
+  endWrite();
+}
+
+/*
+ * @brief Classic built-in font glyph expanded to frame buffer bytes the way
+ * it lands in the frame buffer at one rotation: lines of width bytes, each
+ * drawn repeat times, padded to a multiple of 4 bytes. Bytes are colors,
+ * or 0xFF where text color goes and 0x00 where the background is left
+ * alone for transparent text.
+ */
+struct ESP_8_BIT_GFX::glyph_entry
+{
+  glyph_entry* newer;
+  glyph_entry* older;
+  glyph_entry* next;
+  uint32_t key;
+  uint8_t scale;
+  uint8_t lines;
+  uint8_t repeat;
+  uint16_t width;
+  uint16_t stride;
+  uint16_t bytes;
+
+  uint8_t* rows()
+  {
+    return (uint8_t*)(this + 1);
+  }
+};
+
+// Key of a glyph in the cache, and its hash bucket
+static inline uint32_t glyph_key(unsigned char c, uint8_t fg, uint8_t bg, uint8_t rotation, bool mask)
+{
+  return (uint32_t)c | fg << 8 | bg << 16 | (uint32_t)(rotation & 3) << 24 | (uint32_t)mask << 26;
+}
+
+static inline uint8_t glyph_bucket(uint32_t key, uint8_t scale)
+{
+  return (key ^ key >> 8 ^ key >> 16 ^ key >> 24 ^ scale*7) & 0xFF;
+}
+
+/*
+ * @brief Limit memory used to cache glyphs, dropping least recently used
+ * glyphs to fit
+ */
+void ESP_8_BIT_GFX::setGlyphCacheSize(size_t bytes)
+{
+  _glyphCacheSize = bytes;
+  while (_glyphBytes > _glyphCacheSize)
+  {
+    free(unlinkOldestGlyph());
+  }
+}
+
+/*
+ * @brief Take the least recently used glyph out of the cache, caller
+ * frees or reuses it
+ */
+ESP_8_BIT_GFX::glyph_entry* ESP_8_BIT_GFX::unlinkOldestGlyph()
+{
+  glyph_entry* entry = _glyphOldest;
+  glyph_entry** link = &_glyphBuckets[glyph_bucket(entry->key, entry->scale) % GLYPH_BUCKETS];
+  while (*link != entry)
+  {
+    link = &(*link)->next;
+  }
+  *link = entry->next;
+
+  _glyphOldest = entry->newer;
+  if (_glyphOldest)
+  {
+    _glyphOldest->older = NULL;
+  }
+  else
+  {
+    _glyphNewest = NULL;
+  }
+  _glyphBytes -= entry->bytes;
+  return entry;
+}
+
+/*
+ * @brief Find a glyph for the current rotation in the cache, expanding it
+ * on a miss. Returns NULL if it does not fit in the cache or memory is
+ * short.
+ */
+ESP_8_BIT_GFX::glyph_entry* ESP_8_BIT_GFX::getGlyph(unsigned char c, uint8_t fg, uint8_t bg,
+  uint8_t size_x, uint8_t size_y, bool mask)
+{
+  // Rotated a quarter turn, glyph columns become frame buffer lines
+  bool quarter = rotation & 1;
+  uint8_t scale = quarter ? size_y : size_x;
+  uint32_t key = glyph_key(c, fg, bg, rotation, mask);
+  glyph_entry** bucket = &_glyphBuckets[glyph_bucket(key, scale) % GLYPH_BUCKETS];
+  glyph_entry* entry = *bucket;
+  while (entry && (entry->key != key || entry->scale != scale))
+  {
+    entry = entry->next;
+  }
+
+  if (entry)
+  {
+    // Hit, move to the newest end of the list
+    if (entry != _glyphNewest)
+    {
+      entry->newer->older = entry->older;
+      if (entry->older)
+      {
+        entry->older->newer = entry->newer;
+      }
+      else
+      {
+        _glyphOldest = entry->newer;
+      }
+      entry->older = _glyphNewest;
+      entry->newer = NULL;
+      _glyphNewest->newer = entry;
+      _glyphNewest = entry;
+    }
+    entry->repeat = quarter ? size_x : size_y;
+    return entry;
+  }
+
+  // Miss, make room then expand the glyph
+  uint8_t lines = quarter ? 6 : 8;
+  uint8_t groups = quarter ? 8 : 6;
+  uint16_t width = groups*scale;
+  uint16_t stride = (width + 3) & ~3;
+  size_t bytes = sizeof(glyph_entry) + lines*stride;
+  if (bytes > _glyphCacheSize)
+  {
+    return NULL;
+  }
+  while (_glyphBytes + bytes > _glyphCacheSize)
+  {
+    // Reuse a dropped glyph of the same size rather than reallocate
+    glyph_entry* oldest = unlinkOldestGlyph();
+    if (NULL == entry && oldest->bytes == bytes)
+    {
+      entry = oldest;
+    }
+    else
+    {
+      free(oldest);
+    }
+  }
+  if (NULL == entry)
+  {
+    entry = (glyph_entry*)malloc(bytes);
+  }
+  if (NULL == entry)
+  {
+    return NULL;
+  }
+
+  const unsigned char* columns = &font[c * 5];
+  uint8_t* row = entry->rows();
+  for (uint8_t line = 0; line < lines; line++, row += stride)
+  {
+    for (uint8_t group = 0; group < groups; group++)
+    {
+      // Glyph column i and row j of this group, same as drawPixel()
+      int8_t i, j;
+      switch (rotation) {
+      case 1:
+        i = line;
+        j = 7 - group;
+        break;
+      case 2:
+        i = 5 - group;
+        j = 7 - line;
+        break;
+      case 3:
+        i = 5 - line;
+        j = group;
+        break;
+      default:
+        i = group;
+        j = line;
+        break;
+      }
+      bool on = i < 5 && ((pgm_read_byte(&columns[i]) >> j) & 1);
+      uint8_t value = mask ? (on ? 0xFF : 0x00) : (on ? fg : bg);
+      memset(row + group*scale, value, scale);
+    }
+  }
+
+  entry->key = key;
+  entry->scale = scale;
+  entry->lines = lines;
+  entry->repeat = quarter ? size_x : size_y;
+  entry->width = width;
+  entry->stride = stride;
+  entry->bytes = bytes;
+  entry->next = *bucket;
+  *bucket = entry;
+  entry->newer = NULL;
+  entry->older = _glyphNewest;
+  if (_glyphNewest)
+  {
+    _glyphNewest->newer = entry;
+  }
+  else
+  {
+    _glyphOldest = entry;
+  }
+  _glyphNewest = entry;
+  _glyphBytes += bytes;
+  return entry;
+}
+
+// Copy one glyph row, 32 bits at a time when both ends are aligned
+static inline void copy_row(uint8_t* dst, const uint8_t* src, int w)
+{
+  if (0 == (((uintptr_t)dst | (uintptr_t)src) & 3))
+  {
+    for (; w >= 4; w -= 4, dst += 4, src += 4)
+    {
+      *(uint32_t*)dst = *(const uint32_t*)src;
+    }
+  }
+  memcpy(dst, src, w);
+}
+
+// Put text color where a glyph mask row is set, 32 bits at a time once
+// the frame buffer end is aligned
+static inline void mask_row(uint8_t* dst, const uint8_t* mask, int w, uint8_t fg)
+{
+  for (; w > 0 && ((uintptr_t)dst & 3); w--, dst++, mask++)
+  {
+    if (*mask)
+    {
+      *dst = fg;
+    }
+  }
+  uint32_t fg32 = (uint32_t)fg*0x01010101;
+  for (; w >= 4; w -= 4, dst += 4, mask += 4)
+  {
+    uint32_t m;
+    memcpy(&m, mask, 4);
+    if (m)
+    {
+      *(uint32_t*)dst = (*(uint32_t*)dst & ~m) | (fg32 & m);
+    }
+  }
+  for (; w > 0; w--, dst++, mask++)
+  {
+    if (*mask)
+    {
+      *dst = fg;
+    }
+  }
+}
+
+/*
+ * @brief Draw a glyph of the classic built-in font as runs of text and
+ * background color along each row, for any rotation and frame buffer
+ * format.
+ */
+void ESP_8_BIT_GFX::drawGlyphRuns(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y)
+{
+  uint8_t fore = spanValue(color);
+  uint8_t back = spanValue(bg);
+  bool opaque = bg != color;
+  uint8_t columns[5];
+  for (int8_t i = 0; i < 5; i++)
+  {
+    columns[i] = pgm_read_byte(&font[c * 5 + i]);
+  }
+
+  for (int8_t j = 0; j < 8; j++)
+  {
+    // Bit i of row is column i, column 5 is always background
+    uint8_t row = 0;
+    for (int8_t i = 0; i < 5; i++)
+    {
+      row |= ((columns[i] >> j) & 1) << i;
+    }
+    for (int8_t i = 0; i < 6;)
+    {
+      int8_t start = i;
+      bool on = (row >> i) & 1;
+      while (i < 6 && on == (bool)((row >> i) & 1))
+      {
+        i++;
+      }
+      if (on || opaque)
+      {
+        fillScreenRect(x + start * size_x, y + j * size_y,
+          (i - start) * size_x, size_y, on ? fore : back);
+      }
+    }
+  }
+}
+
+// Fill a few bytes, short runs are not worth a memset() call
+static inline void fill_bytes(uint8_t* dst, uint8_t value, int n)
+{
+  if (n >= 8)
+  {
+    memset(dst, value, n);
+    return;
+  }
+  for (; n > 0; n--)
+  {
+    *dst++ = value;
+  }
+}
+
+// Number of leading one bits of a byte
+static inline uint8_t leading_ones(uint8_t bits)
+{
+  return (uint8_t)~bits ? __builtin_clz((uint32_t)(uint8_t)~bits << 24) : 8;
+}
+
+/*
+ * @brief Draw a glyph of a custom GFXfont, same pixels as Adafruit_GFX.
+ * Each row of the glyph bitmap is decoded into runs of set bits, a byte at
+ * a time, and each run is filled with one memset per frame buffer line.
+ * Glyphs entirely on screen skip all clipping.
+ */
+void ESP_8_BIT_GFX::drawFontGlyph(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint8_t size_x, uint8_t size_y)
+{
+  c -= (uint8_t)pgm_read_byte(&gfxFont->first);
+  const GFXglyph* glyph = &gfxFont->glyph[c];
+  const uint8_t* bitmap = gfxFont->bitmap + pgm_read_word(&glyph->bitmapOffset);
+  int w = pgm_read_byte(&glyph->width);
+  int h = pgm_read_byte(&glyph->height);
+  int left = x + (int8_t)pgm_read_byte(&glyph->xOffset) * size_x;
+  int top = y + (int8_t)pgm_read_byte(&glyph->yOffset) * size_y;
+
+  // Clip the whole glyph
+  if (left >= _width || top >= _height ||
+      left + w * size_x <= 0 || top + h * size_y <= 0)
+  {
+    return;
+  }
+  bool direct = 8 == _bitsPerPixel && left >= 0 && top >= 0 &&
+    left + w * size_x <= _width && top + h * size_y <= _height;
+
+  uint8_t value = spanValue(color);
+  uint8_t bits = 0;
+  uint8_t avail = 0;
+  startWrite();
+  for (int yy = 0; yy < h; yy++)
+  {
+    int xx = 0;
+    while (xx < w)
+    {
+      if (0 == avail)
+      {
+        bits = pgm_read_byte(bitmap++);
+        avail = 8;
+      }
+
+      // Skip clear bits, then take set bits across bytes
+      uint8_t zeros = bits ? __builtin_clz((uint32_t)bits << 24) : 8;
+      zeros = min((int)min(zeros, avail), w - xx);
+      xx += zeros;
+      bits <<= zeros;
+      avail -= zeros;
+      if (0 == avail || xx >= w)
+      {
+        continue;
+      }
+      int start = xx;
+      for (;;)
+      {
+        uint8_t ones = min((int)min(leading_ones(bits), avail), w - xx);
+        xx += ones;
+        bits <<= ones;
+        avail -= ones;
+        if (avail > 0 || xx >= w)
+        {
+          break;
+        }
+        bits = pgm_read_byte(bitmap++);
+        avail = 8;
+        if (0 == (bits & 0x80))
+        {
+          break;
+        }
+      }
+
+      int runX = left + start * size_x;
+      int runY = top + yy * size_y;
+      int runW = (xx - start) * size_x;
+      if (!direct)
+      {
+        fillScreenRect(runX, runY, runW, size_y, value);
+        continue;
+      }
+
+      // Entirely on screen, write the frame buffer as drawPixel() would
+      switch (rotation) {
+      case 1:
+        for (int q = 0; q < runW; q++)
+        {
+          fill_bytes(_lines[runX + q] + WIDTH - runY - size_y, value, size_y);
+        }
+        break;
+      case 2:
+        for (uint8_t k = 0; k < size_y; k++)
+        {
+          fill_bytes(_lines[HEIGHT - 1 - runY - k] + WIDTH - runX - runW, value, runW);
+        }
+        break;
+      case 3:
+        for (int q = 0; q < runW; q++)
+        {
+          fill_bytes(_lines[HEIGHT - 1 - runX - q] + runY, value, size_y);
+        }
+        break;
+      default:
+        for (uint8_t k = 0; k < size_y; k++)
+        {
+          fill_bytes(_lines[runY + k] + runX, value, runW);
+        }
+        break;
+      }
+    }
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw a single character, optimized for ESP_8_BIT. Same pixels as
+            Adafruit_GFX. Classic font text copies rows of a cached glyph
+            into the frame buffer, or is drawn as runs of pixels in
+            monochrome mode. Custom font glyphs are drawn as runs of
+            pixels decoded from their bitmap.
+    @param    x   Bottom left corner x coordinate
+    @param    y   Bottom left corner y coordinate
+    @param    c   The 8-bit font-indexed character (likely ascii)
+    @param    color Color to draw chraracter with
+    @param    bg Color to fill background with (if same as color, no
+              background)
+    @param    size_x  Font magnification level in X-axis, 1 is 'original' size
+    @param    size_y  Font magnification level in Y-axis, 1 is 'original' size
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y)
+{
+  if (gfxFont)
+  {
+    // No background color for custom fonts, by Adafruit_GFX design
+    drawFontGlyph(x, y, c, color, size_x, size_y);
+    return;
+  }
+
+  if ((x >= _width) ||              // Clip right
+      (y >= _height) ||             // Clip bottom
+      ((x + 6 * size_x - 1) < 0) || // Clip left
+      ((y + 8 * size_y - 1) < 0))   // Clip top
+    return;
+
+  if (!_cp437 && (c >= 176))
+    c++; // Handle 'classic' charset behavior
+
+  startWrite();
+  glyph_entry* glyph = NULL;
+  bool opaque = bg != color;
+  uint8_t fore = getColor8(color);
+  if (8 == _bitsPerPixel)
+  {
+    glyph = opaque ? getGlyph(c, fore, getColor8(bg), size_x, size_y, false)
+                   : getGlyph(c, 0, 0, size_x, size_y, true);
+  }
+  if (NULL == glyph)
+  {
+    drawGlyphRuns(x, y, c, color, bg, size_x, size_y);
+    endWrite();
+    return;
+  }
+
+  // Top left corner of the glyph in the frame buffer, same as drawPixel()
+  int frameX, frameY;
+  switch (rotation) {
+  case 1:
+    frameX = WIDTH - y - 8 * size_y;
+    frameY = x;
+    break;
+  case 2:
+    frameX = WIDTH - x - 6 * size_x;
+    frameY = HEIGHT - y - 8 * size_y;
+    break;
+  case 3:
+    frameX = y;
+    frameY = HEIGHT - x - 6 * size_x;
+    break;
+  default:
+    frameX = x;
+    frameY = y;
+    break;
+  }
+
+  int from = max(0, -frameX);
+  int to = min((int)glyph->width, WIDTH - frameX);
+  const uint8_t* row = glyph->rows() + from;
+  int lineY = frameY;
+  for (uint8_t line = 0; line < glyph->lines; line++, row += glyph->stride)
+  {
+    for (uint8_t k = 0; k < glyph->repeat; k++, lineY++)
+    {
+      if (lineY < 0 || lineY >= HEIGHT)
+      {
+        continue;
+      }
+      if (opaque)
+      {
+        copy_row(_lines[lineY] + frameX + from, row, to - from);
+      }
+      else
+      {
+        mask_row(_lines[lineY] + frameX + from, row, to - from, fore);
+      }
+    }
+  }
+  endWrite();
+}
+
+void ESP_8_BIT_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size)
+{
+  drawChar(x, y, c, color, bg, size, size);
+}
+
+/*
+ * @brief Adafruit_GFX override so print() draws text with drawChar() above
+ */
+size_t ESP_8_BIT_GFX::write(uint8_t c)
+{
+  if (!gfxFont) { // 'Classic' built-in font
+
+    if (c == '\n') {              // Newline?
+      cursor_x = 0;               // Reset x to zero,
+      cursor_y += textsize_y * 8; // advance y one line
+    } else if (c != '\r') {       // Ignore carriage returns
+      if (wrap && ((cursor_x + textsize_x * 6) > _width)) { // Off right?
+        cursor_x = 0;                                       // Reset x to zero,
+        cursor_y += textsize_y * 8; // advance y one line
+      }
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
+               textsize_y);
+      cursor_x += textsize_x * 6; // Advance x one char
+    }
+
+  } else { // Custom font
+
+    if (c == '\n') {
+      cursor_x = 0;
+      cursor_y +=
+          (int16_t)textsize_y * (uint8_t)pgm_read_byte(&gfxFont->yAdvance);
+    } else if (c != '\r') {
+      uint8_t first = pgm_read_byte(&gfxFont->first);
+      if ((c >= first) && (c <= (uint8_t)pgm_read_byte(&gfxFont->last))) {
+        const GFXglyph *glyph = &gfxFont->glyph[c - first];
+        uint8_t w = pgm_read_byte(&glyph->width),
+                h = pgm_read_byte(&glyph->height);
+        if ((w > 0) && (h > 0)) { // Is there an associated bitmap?
+          int16_t xo = (int8_t)pgm_read_byte(&glyph->xOffset); // sic
+          if (wrap && ((cursor_x + textsize_x * (xo + w)) > _width)) {
+            cursor_x = 0;
+            cursor_y += (int16_t)textsize_y *
+                        (uint8_t)pgm_read_byte(&gfxFont->yAdvance);
+          }
+          drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x,
+                   textsize_y);
+        }
+        cursor_x +=
+            (uint8_t)pgm_read_byte(&glyph->xAdvance) * (int16_t)textsize_x;
+      }
+    }
+  }
+  return 1;
+}
+
+// 4x4 ordered dither threshold of a pixel, 0 to 15
+static constexpr int bayer4(int x, int y)
+{
+  return 8*((x ^ y) & 1) + 4*(y & 1) + 2*(((x ^ y) >> 1) & 1) + ((y >> 1) & 1);
+}
+
+// Level out of 0..maxOut for a component v out of 0..maxIn, rounded by a
+// dither threshold of 0 to 15, or truncated for threshold 16
+static constexpr int dither_level(int v, int maxIn, int maxOut, int t)
+{
+  return t < 16 ? (v*maxOut*32 + (2*t + 1)*maxIn)/(32*maxIn) : v*(maxOut + 1)/(maxIn + 1);
+}
+
+// RGB332 bits for index k of a lookup row: 32 red, 64 green then 32 blue
+// RGB565 component values
+static constexpr uint8_t rgb565_level(int t, int k)
+{
+  return k < 32 ? dither_level(k, 31, 7, t) << 5 :
+    k < 96 ? dither_level(k - 32, 63, 7, t) << 2 : dither_level(k - 96, 31, 3, t);
+}
+
+/*
+ * @brief RGB565 to RGB332 lookup, one row per dither threshold plus a last
+ * row truncating the same way as convertRGB565toRGB332()
+ */
+struct rgb565_row
+{
+  uint8_t level[128];
+};
+struct rgb565_table
+{
+  rgb565_row row[17];
+};
+
+template<int... K>
+constexpr rgb565_row rgb565_make_row(int t, ESP_8_BIT_index_list<K...>)
+{
+  return {{ rgb565_level(t, K)... }};
+}
+
+template<int... T>
+constexpr rgb565_table rgb565_make_table(ESP_8_BIT_index_list<T...>)
+{
+  return {{ rgb565_make_row(T, ESP_8_BIT_make_index_list<128>::type())... }};
+}
+
+static const rgb565_table rgb565_lookup =
+  rgb565_make_table(ESP_8_BIT_make_index_list<17>::type());
+
+// Pixels converted at a time for rows that can't be converted straight
+// into the frame buffer
+static const int ROW_CHUNK = 256;
+
+// Clip a run of len starting at pos against 0..limit, as first and end
+// offsets into the run. False if nothing is left.
+static inline bool clip_run(int pos, int len, int limit, int& first, int& end)
+{
+  first = max(0, -pos);
+  end = min(len, limit - pos);
+  return first < end;
+}
+
+// Find the next run of set bits in a row of bits, most significant bit
+// first, from bit start up to bit limit. False if there is none.
+static inline bool next_run(const uint8_t* bits, int& start, int& end, int limit)
+{
+  int i = start;
+  for (; i < limit; i = (i | 7) + 1)
+  {
+    uint8_t b = (uint8_t)(pgm_read_byte(&bits[i >> 3]) << (i & 7));
+    if (b)
+    {
+      i += __builtin_clz((uint32_t)b << 24);
+      break;
+    }
+  }
+  if (i >= limit)
+  {
+    return false;
+  }
+  start = i;
+  while (i < limit)
+  {
+    uint8_t avail = 8 - (i & 7);
+    uint8_t ones = min(leading_ones((uint8_t)(pgm_read_byte(&bits[i >> 3]) << (i & 7))), avail);
+    i += ones;
+    if (ones < avail)
+    {
+      break;
+    }
+  }
+  end = min(i, limit);
+  return true;
+}
+
+/*
+ * @brief drawRGBBitmap() converts RGB565 color with a 4x4 ordered dither
+ * when true
+ */
+void ESP_8_BIT_GFX::setBitmapDither(bool dither)
+{
+  _bitmapDither = dither;
+}
+
+/*
+ * @brief Write n RGB332 pixels starting at screen coordinates (x, y),
+ * already clipped to the screen, as drawPixel() would
+ */
+void ESP_8_BIT_GFX::writeRGB332Row(int x, int y, const uint8_t* row, int n)
+{
+  if (8 == _bitsPerPixel)
+  {
+    switch (rotation) {
+    case 1:
+      for (int i = 0; i < n; i++)
+      {
+        _lines[x + i][WIDTH - 1 - y] = row[i];
+      }
+      break;
+    case 2:
+      {
+        uint8_t* dst = _lines[HEIGHT - 1 - y] + WIDTH - 1 - x;
+        for (int i = 0; i < n; i++)
+        {
+          *dst-- = row[i];
+        }
+      }
+      break;
+    case 3:
+      for (int i = 0; i < n; i++)
+      {
+        _lines[HEIGHT - 1 - x - i][y] = row[i];
+      }
+      break;
+    default:
+      memcpy(_lines[y] + x, row, n);
+      break;
+    }
+    return;
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    uint8_t gray = gray_of(row[i], _bitsPerPixel);
+    switch (rotation) {
+    case 1:
+      putGray(_lines[x + i], WIDTH - 1 - y, gray);
+      break;
+    case 2:
+      putGray(_lines[HEIGHT - 1 - y], WIDTH - 1 - x - i, gray);
+      break;
+    case 3:
+      putGray(_lines[HEIGHT - 1 - x - i], y, gray);
+      break;
+    default:
+      putGray(_lines[y], x + i, gray);
+      break;
+    }
+  }
+}
+
+/*
+ * @brief Fill n pixels of a row at screen coordinates (x, y), already
+ * clipped, with a value from spanValue()
+ */
+void ESP_8_BIT_GFX::fillRowRun(int x, int y, int n, uint8_t value)
+{
+  if (8 != _bitsPerPixel)
+  {
+    fillScreenRect(x, y, n, 1, value);
+    return;
+  }
+
+  switch (rotation) {
+  case 1:
+    for (int i = 0; i < n; i++)
+    {
+      _lines[x + i][WIDTH - 1 - y] = value;
+    }
+    break;
+  case 2:
+    fill_bytes(_lines[HEIGHT - 1 - y] + WIDTH - x - n, value, n);
+    break;
+  case 3:
+    for (int i = 0; i < n; i++)
+    {
+      _lines[HEIGHT - 1 - x - i][y] = value;
+    }
+    break;
+  default:
+    fill_bytes(_lines[y] + x, value, n);
+    break;
+  }
+}
+
+/*
+ * @brief Where a row of n pixels at screen coordinates (x, y) is converted
+ * to: straight into the frame buffer when it takes RGB332 pixels in screen
+ * order, otherwise the given buffer for writeRGB332Row()
+ */
+uint8_t* ESP_8_BIT_GFX::rowTarget(int x, int y, uint8_t* buffer)
+{
+  return 0 == rotation && 8 == _bitsPerPixel ? _lines[y] + x : buffer;
+}
+
+/*
+ * @brief Draw n pixels of RGB565 color, or of 8-bit color in the low byte
+ * in 8-bit color depth, at screen coordinates (x, y) already clipped
+ */
+void ESP_8_BIT_GFX::drawRGBRow(int x, int y, const uint16_t* src, int n)
+{
+  if (n > ROW_CHUNK)
+  {
+    drawRGBRow(x, y, src, ROW_CHUNK);
+    drawRGBRow(x + ROW_CHUNK, y, src + ROW_CHUNK, n - ROW_CHUNK);
+    return;
+  }
+
+  uint8_t buffer[ROW_CHUNK];
+  uint8_t* dst = rowTarget(x, y, buffer);
+  if (16 == _colorDepth)
+  {
+    // Lookup row for each of the four columns of the dither pattern
+    const uint8_t* lookup[4];
+    for (int k = 0; k < 4; k++)
+    {
+      lookup[(x + k) & 3] = rgb565_lookup.row[
+        _bitmapDither ? bayer4(x + k, y) : 16].level;
+    }
+    for (int i = 0; i < n; i++)
+    {
+      uint16_t color = pgm_read_word(&src[i]);
+      const uint8_t* level = lookup[(x + i) & 3];
+      dst[i] = level[color >> 11] | level[32 + ((color >> 5) & 63)] | level[96 + (color & 31)];
+    }
+  }
+  else
+  {
+    for (int i = 0; i < n; i++)
+    {
+      dst[i] = (uint8_t)pgm_read_word(&src[i]);
+    }
+  }
+  if (dst == buffer)
+  {
+    writeRGB332Row(x, y, buffer, n);
+  }
+}
+
+/*
+ * @brief Draw n pixels of 8-bit values taken as color, as Adafruit_GFX
+ * does for grayscale bitmaps, at screen coordinates (x, y) already clipped
+ */
+void ESP_8_BIT_GFX::drawGrayRow(int x, int y, const uint8_t* src, int n)
+{
+  if (8 == _colorDepth)
+  {
+    drawRGB332Row(x, y, src, n);
+    return;
+  }
+  if (n > ROW_CHUNK)
+  {
+    drawGrayRow(x, y, src, ROW_CHUNK);
+    drawGrayRow(x + ROW_CHUNK, y, src + ROW_CHUNK, n - ROW_CHUNK);
+    return;
+  }
+
+  uint8_t buffer[ROW_CHUNK];
+  uint8_t* dst = rowTarget(x, y, buffer);
+  for (int i = 0; i < n; i++)
+  {
+    dst[i] = rgb565_to_rgb332(pgm_read_byte(&src[i]));
+  }
+  if (dst == buffer)
+  {
+    writeRGB332Row(x, y, buffer, n);
+  }
+}
+
+/*
+ * @brief Draw n RGB332 pixels at screen coordinates (x, y) already clipped
+ */
+void ESP_8_BIT_GFX::drawRGB332Row(int x, int y, const uint8_t* src, int n)
+{
+  if (0 == rotation && 8 == _bitsPerPixel)
+  {
+    memcpy(_lines[y] + x, src, n);
+  }
+  else
+  {
+    writeRGB332Row(x, y, src, n);
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief      Draw a 1-bit image, same pixels as Adafruit_GFX. Runs of set
+   bits along each row are filled at once, unset bits are transparent.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  byte array with monochrome bitmap
+    @param    w   Width of bitmap in pixels
+    @param    h   Height of bitmap in pixels
+    @param    color Color to draw with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+  int16_t w, int16_t h, uint16_t color)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  int byteWidth = (w + 7)/8;
+  uint8_t value = spanValue(color);
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    const uint8_t* row = bitmap + j*byteWidth;
+    if (0 != rotation || 8 != _bitsPerPixel)
+    {
+      for (int start = i0, end; next_run(row, start, end, i1); start = end)
+      {
+        fillRowRun(x + start, y + j, end - start, value);
+      }
+      continue;
+    }
+
+    // Frame buffer row in screen order, set pixels a byte of bits at a
+    // time, skipping empty ones
+    uint8_t* dst = _lines[y + j] + x;
+    for (int i = i0; i < i1; i = (i | 7) + 1)
+    {
+      uint8_t b = (uint8_t)(pgm_read_byte(&row[i >> 3]) << (i & 7));
+      for (int k = i; b && k < i1; k++, b <<= 1)
+      {
+        if (b & 0x80)
+        {
+          dst[k] = value;
+        }
+      }
+    }
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief      Draw a 1-bit image, same pixels as Adafruit_GFX, with set
+   bits in color and unset bits in background color. Each row is expanded
+   to RGB332 and written at once.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  byte array with monochrome bitmap
+    @param    w   Width of bitmap in pixels
+    @param    h   Height of bitmap in pixels
+    @param    color Color to draw pixels with
+    @param    bg Color to draw background with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+  int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  int byteWidth = (w + 7)/8;
+  uint8_t fore = getColor8(color);
+  uint8_t back = getColor8(bg);
+  uint8_t buffer[ROW_CHUNK];
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    const uint8_t* row = bitmap + j*byteWidth;
+    for (int start = i0; start < i1; start += ROW_CHUNK)
+    {
+      int end = min(start + ROW_CHUNK, i1);
+      uint8_t* dst = rowTarget(x + start, y + j, buffer);
+      uint8_t b = pgm_read_byte(&row[start >> 3]) << (start & 7);
+      for (int i = start; i < end; i++, b <<= 1)
+      {
+        if (0 == (i & 7))
+        {
+          b = pgm_read_byte(&row[i >> 3]);
+        }
+        dst[i - start] = (b & 0x80) ? fore : back;
+      }
+      if (dst == buffer)
+      {
+        writeRGB332Row(x + start, y + j, buffer, end - start);
+      }
+    }
+  }
+  endWrite();
+}
+
+void ESP_8_BIT_GFX::drawBitmap(int16_t x, int16_t y, uint8_t* bitmap,
+  int16_t w, int16_t h, uint16_t color)
+{
+  drawBitmap(x, y, (const uint8_t*)bitmap, w, h, color);
+}
+
+void ESP_8_BIT_GFX::drawBitmap(int16_t x, int16_t y, uint8_t* bitmap,
+  int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  drawBitmap(x, y, (const uint8_t*)bitmap, w, h, color, bg);
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw an 8-bit image a row at a time, same pixels as
+   Adafruit_GFX: each value is taken as a color, RGB332 in 8-bit color
+   depth.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  byte array with grayscale bitmap
+    @param    w   Width of bitmap in pixels
+    @param    h   Height of bitmap in pixels
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawGrayscaleBitmap(int16_t x, int16_t y,
+  const uint8_t bitmap[], int16_t w, int16_t h)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    drawGrayRow(x + i0, y + j, bitmap + j*w + i0, i1 - i0);
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw an 8-bit image with a 1-bit mask (set bits = opaque, unset
+   bits = clear), same pixels as Adafruit_GFX. Each run of set mask bits is
+   written at once.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  byte array with grayscale bitmap
+    @param    mask  byte array with mask bitmap
+    @param    w   Width of bitmap in pixels
+    @param    h   Height of bitmap in pixels
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawGrayscaleBitmap(int16_t x, int16_t y,
+  const uint8_t bitmap[], const uint8_t mask[], int16_t w, int16_t h)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  int byteWidth = (w + 7)/8;
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    const uint8_t* row = mask + j*byteWidth;
+    for (int start = i0, end; next_run(row, start, end, i1); start = end)
+    {
+      drawGrayRow(x + start, y + j, bitmap + j*w + start, end - start);
+    }
+  }
+  endWrite();
+}
+
+void ESP_8_BIT_GFX::drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t* bitmap,
+  int16_t w, int16_t h)
+{
+  drawGrayscaleBitmap(x, y, (const uint8_t*)bitmap, w, h);
+}
+
+void ESP_8_BIT_GFX::drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t* bitmap,
+  uint8_t* mask, int16_t w, int16_t h)
+{
+  drawGrayscaleBitmap(x, y, (const uint8_t*)bitmap, (const uint8_t*)mask, w, h);
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw a 16-bit image (RGB 5/6/5) a row at a time. Color is
+   converted to RGB332 by table lookup, ordered dithered if enabled with
+   setBitmapDither(). Otherwise same pixels as Adafruit_GFX.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  byte array with 16-bit color bitmap
+    @param    w   Width of bitmap in pixels
+    @param    h   Height of bitmap in pixels
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+  int16_t w, int16_t h)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    drawRGBRow(x + i0, y + j, bitmap + j*w + i0, i1 - i0);
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw a 16-bit image (RGB 5/6/5) with a 1-bit mask (set bits =
+   opaque, unset bits = clear) as drawRGBBitmap() above, each run of set
+   mask bits at once.
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    bitmap  byte array with 16-bit color bitmap
+    @param    mask  byte array with monochrome mask bitmap
+    @param    w   Width of bitmap in pixels
+    @param    h   Height of bitmap in pixels
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+  const uint8_t mask[], int16_t w, int16_t h)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  int byteWidth = (w + 7)/8;
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    const uint8_t* row = mask + j*byteWidth;
+    for (int start = i0, end; next_run(row, start, end, i1); start = end)
+    {
+      drawRGBRow(x + start, y + j, bitmap + j*w + start, end - start);
+    }
+  }
+  endWrite();
+}
+
+void ESP_8_BIT_GFX::drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+  int16_t w, int16_t h)
+{
+  drawRGBBitmap(x, y, (const uint16_t*)bitmap, w, h);
+}
+
+void ESP_8_BIT_GFX::drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+  uint8_t* mask, int16_t w, int16_t h)
+{
+  drawRGBBitmap(x, y, (const uint16_t*)bitmap, (const uint8_t*)mask, w, h);
+}
+
+/*
+ * @brief Draw an image of RGB332 pixels, the frame buffer's own format,
+ * copied a row at a time
+ */
+void ESP_8_BIT_GFX::drawRGB332Bitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+  int16_t w, int16_t h)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  startWrite();
+  for (int j = j0; j < j1; j++)
+  {
+    drawRGB332Row(x + i0, y + j, bitmap + j*w + i0, i1 - i0);
+  }
+  endWrite();
+}
+
+// Next 4 sprite pixels, read forward or backward from src
+static inline uint32_t sprite_word(const uint8_t*& src, bool reverse)
+{
+  uint32_t pixels;
+  if (reverse)
+  {
+    src -= 4;
+    memcpy(&pixels, src + 1, 4);
+    return __builtin_bswap32(pixels);
+  }
+  memcpy(&pixels, src, 4);
+  src += 4;
+  return pixels;
+}
+
+// Copy n sprite pixels into a frame buffer row, reading src forward or
+// backward, leaving pixels of the color key out unless key is negative.
+// Whole words are written once the frame buffer end is aligned.
+static void blit_row(uint8_t* dst, const uint8_t* src, int n, bool reverse, int16_t key)
+{
+  if (key < 0 && !reverse)
+  {
+    memcpy(dst, src, n);
+    return;
+  }
+
+  int step = reverse ? -1 : 1;
+  for (; n > 0 && ((uintptr_t)dst & 3); n--, dst++, src += step)
+  {
+    if (*src != key)
+    {
+      *dst = *src;
+    }
+  }
+  uint32_t key32 = (uint32_t)(uint8_t)key*0x01010101;
+  for (; n >= 4; n -= 4, dst += 4)
+  {
+    uint32_t pixels = sprite_word(src, reverse);
+    uint32_t m = key < 0 ? 0xFFFFFFFF : ESP_8_BIT_keyMask332(pixels, key32);
+    if (0xFFFFFFFF == m)
+    {
+      *(uint32_t*)dst = pixels;
+    }
+    else if (m)
+    {
+      *(uint32_t*)dst = (*(uint32_t*)dst & ~m) | (pixels & m);
+    }
+  }
+  for (; n > 0; n--, dst++, src += step)
+  {
+    if (*src != key)
+    {
+      *dst = *src;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw part of a sprite sheet of RGB332 pixels, optionally
+   mirrored, leaving out pixels of a color key. Clipped once per call and
+   copied straight into the frame buffer, a word at a time in rotation 0
+   and 2.
+    @param    x   Top left corner x coordinate on screen
+    @param    y   Top left corner y coordinate on screen
+    @param    sheet  RGB332 pixels of the sprite sheet
+    @param    sheetWidth  Bytes per row of the sprite sheet
+    @param    sx  Left of the sprite within the sheet
+    @param    sy  Top of the sprite within the sheet
+    @param    w   Width of the sprite in pixels
+    @param    h   Height of the sprite in pixels
+    @param    colorKey  Transparent RGB332 color, or negative for none
+    @param    flip  SPRITE_FLIP_X and/or SPRITE_FLIP_Y to mirror the sprite
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawSprite(int16_t x, int16_t y, const uint8_t sheet[],
+  int16_t sheetWidth, int16_t sx, int16_t sy, int16_t w, int16_t h,
+  int16_t colorKey, uint8_t flip)
+{
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1))
+  {
+    return;
+  }
+
+  bool flipX = flip & SPRITE_FLIP_X;
+  bool flipY = flip & SPRITE_FLIP_Y;
+  startWrite();
+  if (8 == _bitsPerPixel && (rotation & 1))
+  {
+    // Screen columns run along frame buffer lines, bottom to top in
+    // rotation 1 and top to bottom in rotation 3
+    int first = 1 == rotation ? j1 - 1 : j0;
+    int step = (1 == rotation) != flipY ? -sheetWidth : sheetWidth;
+    for (int i = i0; i < i1; i++)
+    {
+      uint8_t* dst = 1 == rotation ? _lines[x + i] + WIDTH - y - j1 :
+        _lines[HEIGHT - 1 - x - i] + y + j0;
+      const uint8_t* src = sheet + (sy + (flipY ? h - 1 - first : first))*sheetWidth +
+        sx + (flipX ? w - 1 - i : i);
+      for (int k = 0; k < j1 - j0; k++, src += step)
+      {
+        if (*src != colorKey)
+        {
+          dst[k] = *src;
+        }
+      }
+    }
+    endWrite();
+    return;
+  }
+
+  uint8_t buffer[ROW_CHUNK];
+  for (int j = j0; j < j1; j++)
+  {
+    const uint8_t* row = sheet + (sy + (flipY ? h - 1 - j : j))*sheetWidth + sx;
+    if (8 == _bitsPerPixel && 0 == rotation)
+    {
+      blit_row(_lines[y + j] + x + i0, flipX ? row + w - 1 - i0 : row + i0,
+        i1 - i0, flipX, colorKey);
+      continue;
+    }
+    if (8 == _bitsPerPixel && 2 == rotation)
+    {
+      // Screen row runs right to left along the frame buffer line
+      blit_row(_lines[HEIGHT - 1 - y - j] + WIDTH - x - i1,
+        flipX ? row + w - i1 : row + i1 - 1, i1 - i0, !flipX, colorKey);
+      continue;
+    }
+
+    // Gather the row in screen order, write runs of opaque pixels
+    for (int start = i0; start < i1; start += ROW_CHUNK)
+    {
+      int n = min(ROW_CHUNK, i1 - start);
+      for (int k = 0; k < n; k++)
+      {
+        buffer[k] = row[flipX ? w - 1 - start - k : start + k];
+      }
+      for (int k = 0; k < n;)
+      {
+        for (; k < n && buffer[k] == colorKey; k++)
+        {
+        }
+        int run = k;
+        for (; k < n && buffer[k] != colorKey; k++)
+        {
+        }
+        if (k > run)
+        {
+          writeRGB332Row(x + start + run, y + j, buffer + run, k - run);
+        }
+      }
+    }
+  }
+  endWrite();
+}
+
+/*
+ * @brief Source image of drawAffine(): pixel at 16.16 fixed point
+ * coordinates, wrapping around in both directions when tiled
+ */
+struct affine_source
+{
+  const uint8_t* bitmap;
+  int16_t w;
+  uint8_t shift;
+  uint32_t umask;
+  uint32_t vmask;
+
+  template<bool TILED> inline uint8_t at(uint32_t u, uint32_t v) const
+  {
+    return TILED ? bitmap[((v >> 16) & vmask) << shift | ((u >> 16) & umask)] :
+      bitmap[(v >> 16)*w + (u >> 16)];
+  }
+};
+
+// Fill a frame buffer span stepping through the source image
+template<bool TILED, bool KEYED>
+static void affine_span(uint8_t* dst, int n, const affine_source& src,
+  uint32_t u, uint32_t v, int32_t du, int32_t dv, uint8_t key)
+{
+  for (int i = 0; i < n; i++, u += du, v += dv)
+  {
+    uint8_t p = src.at<TILED>(u, v);
+    if (!KEYED || p != key)
+    {
+      dst[i] = p;
+    }
+  }
+}
+
+typedef void (*affine_span_writer)(uint8_t* dst, int n, const affine_source& src,
+  uint32_t u, uint32_t v, int32_t du, int32_t dv, uint8_t key);
+
+// Narrow [start, end) towards the k where 0 <= base + k*step < limit,
+// estimated in floating point with pixels to spare on either side
+static inline void narrow_span(int64_t base, int32_t step, int64_t limit, int& start, int& end)
+{
+  if (0 == step)
+  {
+    if (base < 0 || base >= limit)
+    {
+      end = start;
+    }
+    return;
+  }
+  float a = (float)(-base)/step;
+  float b = (float)(limit - base)/step;
+  float lo = min(a, b) - 2;
+  float hi = max(a, b) + 2;
+  if (lo > (float)start)
+  {
+    start = lo >= (float)end ? end : (int)lo;
+  }
+  if (hi < (float)end)
+  {
+    end = hi <= (float)start ? start : (int)hi + 1;
+  }
+}
+
+/*
+ * @brief Draw an image through an affine map into screen area
+ * [x0, x1) by [y0, y1), already clipped. Each frame buffer pixel center
+ * is mapped back into the image: rotated by -degrees and divided by scale
+ * around screen point (cx, cy), which shows image point (w/2, h/2). The
+ * screen rotation is folded into the same map so spans always run along
+ * frame buffer lines. Source coordinates are 16.16 fixed point, stepped by
+ * one add per pixel. Unless tiled, each span is cut to the pixels landing
+ * inside the image, found by estimate and checked exactly at both ends.
+ */
+void ESP_8_BIT_GFX::drawAffine(int x0, int y0, int x1, int y1,
+  const uint8_t* bitmap, int16_t w, int16_t h, bool tiled,
+  float cx, float cy, float degrees, float scale, int16_t colorKey)
+{
+  // Frame buffer area and screen coordinates (sx, sy) of frame buffer
+  // coordinates (fx, fy): sx = ox + ax*fx + bx*fy, sy = oy + ay*fx + by*fy
+  int fx0, fy0, fx1, fy1;
+  float ox = 0, ax = 1, bx = 0, oy = 0, ay = 0, by = 1;
+  switch (rotation) {
+  case 1:
+    fx0 = WIDTH - y1; fy0 = x0; fx1 = WIDTH - y0; fy1 = x1;
+    ox = 0; ax = 0; bx = 1; oy = WIDTH; ay = -1; by = 0;
+    break;
+  case 2:
+    fx0 = WIDTH - x1; fy0 = HEIGHT - y1; fx1 = WIDTH - x0; fy1 = HEIGHT - y0;
+    ox = WIDTH; ax = -1; bx = 0; oy = HEIGHT; ay = 0; by = -1;
+    break;
+  case 3:
+    fx0 = y0; fy0 = HEIGHT - x1; fx1 = y1; fy1 = HEIGHT - x0;
+    ox = HEIGHT; ax = 0; bx = -1; oy = 0; ay = 1; by = 0;
+    break;
+  default:
+    fx0 = x0; fy0 = y0; fx1 = x1; fy1 = y1;
+    break;
+  }
+
+  // Image coordinates (u, v) of screen coordinates:
+  // u = w/2 + A*(sx - cx) + B*(sy - cy), v = h/2 + C*(sx - cx) + D*(sy - cy)
+  float radians = degrees*(float)M_PI/180;
+  float A = cosf(radians)/scale;
+  float B = sinf(radians)/scale;
+  float C = -B;
+  float D = A;
+  float sx = ox + (ax + bx)/2 - cx;
+  float sy = oy + (ay + by)/2 - cy;
+  int64_t u00 = (int64_t)floorf((w/2.0f + A*sx + B*sy)*65536);
+  int64_t v00 = (int64_t)floorf((h/2.0f + C*sx + D*sy)*65536);
+  int32_t dux = (int32_t)lroundf((A*ax + B*ay)*65536);
+  int32_t duy = (int32_t)lroundf((A*bx + B*by)*65536);
+  int32_t dvx = (int32_t)lroundf((C*ax + D*ay)*65536);
+  int32_t dvy = (int32_t)lroundf((C*bx + D*by)*65536);
+  int64_t uLimit = (int64_t)w << 16;
+  int64_t vLimit = (int64_t)h << 16;
+
+  affine_source src = { bitmap, w, 0, (uint32_t)w - 1, (uint32_t)h - 1 };
+  for (; (1 << src.shift) < w; src.shift++)
+  {
+  }
+  static const affine_span_writer writers[2][2] = {
+    { affine_span<false, false>, affine_span<false, true> },
+    { affine_span<true, false>, affine_span<true, true> }
+  };
+  affine_span_writer writer = writers[tiled][colorKey >= 0];
+
+  startWrite();
+  for (int fy = fy0; fy < fy1; fy++)
+  {
+    int64_t uRow = u00 + (int64_t)fy*duy;
+    int64_t vRow = v00 + (int64_t)fy*dvy;
+    int start = fx0;
+    int end = fx1;
+    if (!tiled)
+    {
+      narrow_span(uRow, dux, uLimit, start, end);
+      narrow_span(vRow, dvx, vLimit, start, end);
+      for (; start < end; start++)
+      {
+        int64_t u = uRow + (int64_t)start*dux;
+        int64_t v = vRow + (int64_t)start*dvx;
+        if (u >= 0 && u < uLimit && v >= 0 && v < vLimit)
+        {
+          break;
+        }
+      }
+      for (; end > start; end--)
+      {
+        int64_t u = uRow + (int64_t)(end - 1)*dux;
+        int64_t v = vRow + (int64_t)(end - 1)*dvx;
+        if (u >= 0 && u < uLimit && v >= 0 && v < vLimit)
+        {
+          break;
+        }
+      }
+    }
+    uint32_t u = (uint32_t)(uRow + (int64_t)start*dux);
+    uint32_t v = (uint32_t)(vRow + (int64_t)start*dvx);
+    if (8 == _bitsPerPixel)
+    {
+      writer(_lines[fy] + start, end - start, src, u, v, dux, dvx, colorKey);
+      continue;
+    }
+    for (int fx = start; fx < end; fx++, u += dux, v += dvx)
+    {
+      uint8_t p = tiled ? src.at<true>(u, v) : src.at<false>(u, v);
+      if (p != colorKey)
+      {
+        putGray(_lines[fy], fx, gray_of(p, _bitsPerPixel));
+      }
+    }
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief   Draw an image of RGB332 pixels rotated and scaled around its
+   center, leaving out pixels of a color key.
+    @param    x   Screen x coordinate of the image center
+    @param    y   Screen y coordinate of the image center
+    @param    bitmap  RGB332 pixels, w bytes per row
+    @param    w   Width of the image in pixels
+    @param    h   Height of the image in pixels
+    @param    degrees  Clockwise rotation
+    @param    scale  Size on screen relative to the image, 1/1024 or more
+    @param    colorKey  Transparent RGB332 color, or negative for none
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawRotatedBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+  int16_t w, int16_t h, float degrees, float scale, int16_t colorKey)
+{
+  if (w < 1 || h < 1 || !(scale >= 1.0f/1024))
+  {
+    return;
+  }
+
+  // Screen bounding box of the rotated image, with a pixel to spare
+  float radians = degrees*(float)M_PI/180;
+  float c = fabsf(cosf(radians))*scale;
+  float s = fabsf(sinf(radians))*scale;
+  float halfW = (c*w + s*h)/2 + 1;
+  float halfH = (s*w + c*h)/2 + 1;
+  int x0 = max((int)floorf(x - halfW), 0);
+  int y0 = max((int)floorf(y - halfH), 0);
+  int x1 = min((int)ceilf(x + halfW), (int)_width);
+  int y1 = min((int)ceilf(y + halfH), (int)_height);
+  if (x0 >= x1 || y0 >= y1)
+  {
+    return;
+  }
+
+  drawAffine(x0, y0, x1, y1, bitmap, w, h, false, x, y, degrees, scale, colorKey);
+}
+
+/**************************************************************************/
+/*!
+   @brief   Fill a rectangle with copies of an image of RGB332 pixels
+   repeated in both directions, rotated and scaled around one point. A
+   rotozoom effect when angle and scale change from frame to frame.
+    @param    x   Top left corner x coordinate of the rectangle
+    @param    y   Top left corner y coordinate of the rectangle
+    @param    w   Width of the rectangle in pixels
+    @param    h   Height of the rectangle in pixels
+    @param    bitmap  RGB332 pixels, bw bytes per row
+    @param    bw  Width of the image in pixels, a power of two
+    @param    bh  Height of the image in pixels, a power of two
+    @param    cx  Screen x coordinate where the center of a copy lands
+    @param    cy  Screen y coordinate where the center of a copy lands
+    @param    degrees  Clockwise rotation
+    @param    scale  Size on screen relative to the image, 1/1024 or more
+    @param    colorKey  Transparent RGB332 color, or negative for none
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::fillRectRotatedBitmap(int16_t x, int16_t y, int16_t w, int16_t h,
+  const uint8_t bitmap[], int16_t bw, int16_t bh, int16_t cx, int16_t cy,
+  float degrees, float scale, int16_t colorKey)
+{
+  if (bw < 1 || bh < 1 || (bw & (bw - 1)) || (bh & (bh - 1)))
+  {
+    ESP_LOGE(TAG, "Repeated image size must be a power of two");
+    return;
+  }
+  int i0, i1, j0, j1;
+  if (!clip_run(x, w, _width, i0, i1) || !clip_run(y, h, _height, j0, j1) ||
+      !(scale >= 1.0f/1024))
+  {
+    return;
+  }
+
+  drawAffine(x + i0, y + j0, x + i1, y + j1, bitmap, bw, bh, true, cx, cy,
+    degrees, scale, colorKey);
+}
+
+/**************************************************************************/
+/*!
+   @brief    Draw a perfectly vertical line, optimized for ESP_8_BIT
+    @param    x   Top-most x coordinate
+    @param    y   Top-most y coordinate
+    @param    h   Height in pixels
+   @param    color Color to fill with.
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  startWrite();
+  writeFillRect(x, y, 1, h, color);
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief    Draw a perfectly horizontal line, optimized for ESP_8_BIT
+    @param    x   Left-most x coordinate
+    @param    y   Left-most y coordinate
+    @param    w   Width in pixels
+   @param    color Color to fill with
+*/
+/**************************************************************************/
+
+void ESP_8_BIT_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  startWrite();
+  writeFillRect(x, y, w, 1, color);
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief    Fill a rectangle completely with one color, optimized for ESP_8_BIT
+    @param    x   Top left corner x coordinate
+    @param    y   Top left corner y coordinate
+    @param    w   Width in pixels
+    @param    h   Height in pixels
+   @param    color Color to fill with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief    Fill the screen completely with one color, optimized for ESP_8_BIT.
+    @param    color Color to fill with
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::fillScreen(uint16_t color)
+{
+  uint8_t color8 = 8 == _bitsPerPixel ? getColor8(color) : grayPattern(getGray(color));
+  uint8_t** lines = _lines;
+
+  startWrite();
+  // We can't do a single memset() because it is valid for _lines to point
+  // into non-contingous pieces of memory. (Necessary when memory is
+  // fragmented and we can't get a big enough chunk of contiguous bytes.)
+  for(int16_t y = 0; y < HEIGHT; y++)
+  {
+    memset(lines[y], color8, WIDTH*_bitsPerPixel/8);
+  }
+  endWrite();
+}
+
+/**************************************************************************/
+/*!
+   @brief    Invert colors on screen via palette, optimized for ESP_8_BIT.
+    @param    i   True to invert, false to return to normal colors
+*/
+/**************************************************************************/
+void ESP_8_BIT_GFX::invertDisplay(bool i)
+{
+  _pVideo->setInvert(i);
+}
+
+/*
+ * @brief Underlying ESP_8_BIT video generator, for features beyond the
+ * Adafruit GFX API such as palette effects.
+ */
+ESP_8_BIT_composite* ESP_8_BIT_GFX::getComposite()
+{
+  return _pVideo;
+}
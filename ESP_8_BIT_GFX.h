@@ -24,6 +24,12 @@ depending on passsing "8" or "16" into the constructor:
 
 An utility function RGB565toRGB332 is available to perform this conversion.
 
+NOTE RE:MONOCHROME
+
+With ESP_8_BIT_composite::setMonochrome() called on getComposite() before
+begin(), colors are still given as above and drawn as their luminance,
+reduced to black and white or 4 gray levels.
+
 NOTE RE:ASPECT RATIO
 
 Adafruit GFX assumes pixels are square, but this is not true of ESP_8_BIT
@@ -87,6 +93,22 @@ class ESP_8_BIT_GFX : public Adafruit_GFX {
      */
     void waitForFrame();
 
+    /*
+     * @brief Send one band of the frame to screen without waiting for the
+     * whole frame, honoring copyAfterSwap for that band.
+     * @note See ESP_8_BIT_composite::presentBand(), band size is set with
+     * getComposite()->setBandCount().
+     */
+    void presentBand(int band);
+
+    /*
+     * @brief Send the frame to screen at the next line without waiting for
+     * vertical blank, see ESP_8_BIT_composite::presentImmediate().
+     * @note Use this rather than getComposite()->presentImmediate() so
+     * drawing follows the buffer swap.
+     */
+    void presentImmediate();
+
     /*
      * @brief Fraction of time in waitForFrame() in percent of percent.
      * @return Number range from 0 to 10000. Higher values indicate more time
@@ -116,6 +138,22 @@ class ESP_8_BIT_GFX : public Adafruit_GFX {
      */
     void drawPixel(int16_t x, int16_t y, uint16_t color) override;
 
+    /*
+     * @brief Adafruit_GFX override to also pick the matching pixel writer
+     */
+    void setRotation(uint8_t r) override;
+
+    /*
+     * @brief Adafruit_GFX overrides used by its shapes, bitmaps and text
+     * between startWrite() and endWrite(). Write straight into the back
+     * buffer.
+     */
+    void writePixel(int16_t x, int16_t y, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override;
+
     /*
      * @brief Optional Adafruit_GFX overrides for performance
      */
@@ -123,6 +161,169 @@ class ESP_8_BIT_GFX : public Adafruit_GFX {
     void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
     void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
     void fillScreen(uint16_t color) override;
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override;
+
+    /*
+     * @brief Same pixels as their Adafruit_GFX counterparts, drawn as one
+     * span per row with edges stepped in integer arithmetic instead of
+     * many short lines.
+     * @note These are not virtual in Adafruit_GFX, calls through an
+     * Adafruit_GFX pointer or reference still get the Adafruit_GFX version.
+     */
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+      int16_t x2, int16_t y2, uint16_t color);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h,
+      int16_t r, uint16_t color);
+
+    /*
+     * @brief Maximum number of vertices for fillPolygon()
+     */
+    static const uint16_t MAX_POLYGON_POINTS = 32;
+
+    /*
+     * @brief Fill a polygon, convex, concave or self intersecting, using
+     * the even-odd rule.
+     * @param points x and y coordinate of each vertex in turn, 2*count
+     * values. Vertices are pixel centers, the last connects to the first.
+     * @param count Number of vertices, up to MAX_POLYGON_POINTS
+     * @note Pixels on left and top edges are filled and those on right and
+     * bottom edges are not, so polygons sharing an edge never overlap. A
+     * rectangle from (x, y) to (x+w, y+h) fills the same pixels as
+     * fillRect(x, y, w, h).
+     */
+    void fillPolygon(const int16_t* points, uint16_t count, uint16_t color);
+
+    /*
+     * @brief Draw a character, same pixels as Adafruit_GFX. In the classic
+     * built-in font, text is copied a row at a time from a cache of glyphs
+     * already expanded to RGB332 bytes for the text size, colors and
+     * rotation in use, or drawn as runs of pixels in monochrome mode.
+     * Custom GFXfont glyphs are decoded into runs of set bits along each
+     * row, filled a frame buffer line at a time, and clipped once per
+     * glyph.
+     * @note Not virtual in Adafruit_GFX, but print() and friends reach
+     * them through the write() override.
+     */
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+      uint16_t bg, uint8_t size);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+      uint16_t bg, uint8_t size_x, uint8_t size_y);
+    using Print::write;
+    size_t write(uint8_t c) override;
+
+    /*
+     * @brief Memory limit of the glyph cache in bytes, defaults to 8192.
+     * Each glyph takes 8 rows of 6 bytes per text size, rounded up to a
+     * multiple of 4, plus a small header. Transparent text (same text and
+     * background color) shares one glyph for all text colors. The least
+     * recently used glyphs are dropped to stay within the limit. 0
+     * disables the cache.
+     */
+    void setGlyphCacheSize(size_t bytes);
+
+    /*
+     * @brief Same pixels as their Adafruit_GFX counterparts, drawn a row
+     * at a time, clipped to the screen once per row. Color of 16-bit
+     * (RGB565) images is converted to RGB332 by table lookup.
+     * drawGrayscaleBitmap() takes each value as a color, as Adafruit_GFX
+     * does, so in 8-bit color depth it draws RGB332 images.
+     * @note These are not virtual in Adafruit_GFX, calls through an
+     * Adafruit_GFX pointer or reference still get the Adafruit_GFX version.
+     */
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+      int16_t h, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+      int16_t h, uint16_t color, uint16_t bg);
+    void drawBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w,
+      int16_t h, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, uint8_t* bitmap, int16_t w,
+      int16_t h, uint16_t color, uint16_t bg);
+    void drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+      int16_t w, int16_t h);
+    void drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t* bitmap,
+      int16_t w, int16_t h);
+    void drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+      const uint8_t mask[], int16_t w, int16_t h);
+    void drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t* bitmap,
+      uint8_t* mask, int16_t w, int16_t h);
+    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+      int16_t w, int16_t h);
+    void drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+      int16_t w, int16_t h);
+    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
+      const uint8_t mask[], int16_t w, int16_t h);
+    void drawRGBBitmap(int16_t x, int16_t y, uint16_t* bitmap,
+      uint8_t* mask, int16_t w, int16_t h);
+
+    /*
+     * @brief Draw an image of RGB332 pixels, w bytes per row, copied
+     * straight into the frame buffer. Fastest way to put an image on
+     * screen, in either color depth.
+     */
+    void drawRGB332Bitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+      int16_t w, int16_t h);
+
+    /*
+     * @brief Flags for drawSprite() to mirror a sprite left to right and
+     * top to bottom
+     */
+    static const uint8_t SPRITE_FLIP_X = 1;
+    static const uint8_t SPRITE_FLIP_Y = 2;
+
+    /*
+     * @brief Draw the w by h sprite at (sx, sy) of a sheet of RGB332
+     * pixels, sheetWidth bytes per row, with its top left corner at (x, y)
+     * on screen. Pixels of colorKey are transparent, pass a negative
+     * colorKey to draw every pixel. Clipped to the screen once per call
+     * and copied straight into the frame buffer, a word at a time in
+     * rotation 0 and 2.
+     */
+    void drawSprite(int16_t x, int16_t y, const uint8_t sheet[],
+      int16_t sheetWidth, int16_t sx, int16_t sy, int16_t w, int16_t h,
+      int16_t colorKey = -1, uint8_t flip = 0);
+
+    /*
+     * @brief Draw an image of RGB332 pixels, w bytes per row, rotated
+     * clockwise by degrees and scaled around its center, which lands on
+     * screen point (x, y). Pixels of colorKey are transparent, pass a
+     * negative colorKey to draw every pixel. Each screen pixel takes the
+     * image pixel under its center, stepped along frame buffer lines in
+     * fixed point arithmetic.
+     */
+    void drawRotatedBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+      int16_t w, int16_t h, float degrees, float scale, int16_t colorKey = -1);
+
+    /*
+     * @brief Fill the rectangle (x, y, w, h) with an image of RGB332
+     * pixels repeated in both directions, rotated and scaled as
+     * drawRotatedBitmap() with the center of one copy on screen point
+     * (cx, cy). Image width bw and height bh must be powers of two.
+     * Rotozoom effect.
+     */
+    void fillRectRotatedBitmap(int16_t x, int16_t y, int16_t w, int16_t h,
+      const uint8_t bitmap[], int16_t bw, int16_t bh, int16_t cx, int16_t cy,
+      float degrees, float scale, int16_t colorKey = -1);
+
+    /*
+     * @brief Set to true to convert RGB565 images of drawRGBBitmap() with
+     * a 4x4 ordered dither instead of dropping the low bits of each
+     * component, trading a fine pattern for smooth gradients. Only used in
+     * 16-bit color depth. Defaults to false.
+     */
+    void setBitmapDither(bool dither);
+
+    /*
+     * @brief Adafruit_GFX override to invert colors on screen. Implemented
+     * by swapping in an inverted palette, no frame buffer pixels are touched.
+     */
+    void invertDisplay(bool i) override;
+
+    /*
+     * @brief Underlying ESP_8_BIT video generator, for features beyond the
+     * Adafruit GFX API such as palette effects.
+     */
+    ESP_8_BIT_composite* getComposite();
 
     /*
      * @brief Set this to true if the frame buffer should be copied upon every
@@ -133,30 +334,123 @@ class ESP_8_BIT_GFX : public Adafruit_GFX {
     bool copyAfterSwap;
   private:
     /*
-     * @brief Given input X-coordinate, return value clamped within valid range.
+     * @brief Fill part of one frame buffer line, a rectangle in frame
+     * buffer coordinates and a rectangle in rotated screen coordinates,
+     * clipped to the frame buffer. Value is from spanValue().
+     */
+    void fillSpan(uint8_t* line, int16_t x, int16_t w, uint8_t value);
+    void fillFrameRect(int x, int y, int w, int h, uint8_t value);
+    void fillScreenRect(int x, int y, int w, int h, uint8_t value);
+
+    /*
+     * @brief Value written to the frame buffer for a color: RGB332 color,
+     * or gray level in monochrome mode
+     */
+    uint8_t spanValue(uint16_t color);
+
+    /*
+     * @brief Fill a circle split apart into halves, for fillCircle() and
+     * fillRoundRect()
+     */
+    void fillRoundSpans(int xl, int xr, int cy, int16_t r, int16_t delta, uint8_t value);
+
+    /*
+     * @brief Bitmap rows of n pixels at screen coordinates (x, y), already
+     * clipped. fillRowRun() fills them with a value from spanValue().
+     * rowTarget() is where to convert pixels to: the frame buffer
+     * itself when possible, otherwise buffer, which is then written by
+     * writeRGB332Row().
+     */
+    void writeRGB332Row(int x, int y, const uint8_t* row, int n);
+    void fillRowRun(int x, int y, int n, uint8_t value);
+    uint8_t* rowTarget(int x, int y, uint8_t* buffer);
+    void drawRGBRow(int x, int y, const uint16_t* src, int n);
+    void drawGrayRow(int x, int y, const uint8_t* src, int n);
+    void drawRGB332Row(int x, int y, const uint8_t* src, int n);
+
+    /*
+     * @brief Draw an image through an affine map into a screen area
+     * already clipped, for drawRotatedBitmap() and fillRectRotatedBitmap()
      */
-    int16_t clampX(int16_t inputX);
+    void drawAffine(int x0, int y0, int x1, int y1, const uint8_t* bitmap,
+      int16_t w, int16_t h, bool tiled, float cx, float cy, float degrees,
+      float scale, int16_t colorKey);
 
     /*
-     * @brief Given input Y-coordinate, return value clamped within valid range.
+     * @brief Whether drawRGBBitmap() dithers, see setBitmapDither()
      */
-    int16_t clampY(int16_t inputY);
+    bool _bitmapDither;
 
     /*
      * @brief Whether to treat color as 8 or 16 bit color values
      */
     uint8_t _colorDepth;
 
+    /*
+     * @brief Frame buffer bits per pixel, 1 or 2 in monochrome mode
+     */
+    uint8_t _bitsPerPixel;
+
     /*
      * @brief Internal reference to ESP_8_BIT video generator wrapper class
      */
     ESP_8_BIT_composite* _pVideo;
 
+    /*
+     * @brief Back buffer lines array, refreshed whenever buffers swap
+     */
+    uint8_t** _lines;
+
+    /*
+     * @brief drawPixel() implementation for current rotation, color depth
+     * and frame buffer format, bound by bindPixelWriter()
+     */
+    typedef void (ESP_8_BIT_GFX::*pixel_writer)(int16_t x, int16_t y, uint16_t color);
+    pixel_writer _pixelWriter;
+    void bindPixelWriter();
+    template<uint8_t ROTATION, uint8_t COLOR_DEPTH, uint8_t BITS>
+    void writePixelAs(int16_t x, int16_t y, uint16_t color);
+
+    /*
+     * @brief Glyph cache for drawChar(): hash buckets and a least recently
+     * used list of expanded glyphs, with bytes used and allowed
+     */
+    struct glyph_entry;
+    static const uint8_t GLYPH_BUCKETS = 32;
+    glyph_entry* _glyphBuckets[GLYPH_BUCKETS];
+    glyph_entry* _glyphNewest;
+    glyph_entry* _glyphOldest;
+    size_t _glyphBytes;
+    size_t _glyphCacheSize;
+    glyph_entry* getGlyph(unsigned char c, uint8_t fg, uint8_t bg, uint8_t size_x,
+      uint8_t size_y, bool mask);
+    glyph_entry* unlinkOldestGlyph();
+    void drawGlyphRuns(int16_t x, int16_t y, unsigned char c, uint16_t color,
+      uint16_t bg, uint8_t size_x, uint8_t size_y);
+
+    /*
+     * @brief Draw a glyph of the custom GFXfont set with setFont()
+     */
+    void drawFontGlyph(int16_t x, int16_t y, unsigned char c, uint16_t color,
+      uint8_t size_x, uint8_t size_y);
+
     /*
      * @brief Retrieve color to use depending on _colorDepth
      */
     uint8_t getColor8(uint16_t color);
 
+    /*
+     * @brief Retrieve gray level to use in monochrome mode, and a byte
+     * filled with it
+     */
+    uint8_t getGray(uint16_t color);
+    uint8_t grayPattern(uint8_t gray);
+
+    /*
+     * @brief Set one pixel of a monochrome frame buffer line
+     */
+    void putGray(uint8_t* line, int16_t x, uint8_t gray);
+
 
     /////////////////////////////////////////////////////////////////////////
     //
@@ -20,6 +20,7 @@
 */
 
 #include "ESP_8_BIT_composite.h"
+#include "ESP_8_BIT_palette.h"
 
 static const char *TAG = "ESP_8_BIT";
 
@@ -743,7 +744,7 @@ void video_init_hw(int line_width, int samples_per_cc)
 
 // ntsc phase representation of a rrrgggbb pixel
 // must be in RAM so VBL works
-const static DRAM_ATTR uint32_t ntsc_RGB332[256] = {
+constexpr static DRAM_ATTR uint32_t ntsc_RGB332[256] = {
     0x18181818,0x18171A1C,0x1A151D22,0x1B141F26,0x1D1C1A1B,0x1E1B1C20,0x20191F26,0x2119222A,
     0x23201C1F,0x241F1E24,0x251E222A,0x261D242E,0x29241F23,0x2A232128,0x2B22242E,0x2C212632,
     0x2E282127,0x2F27232C,0x31262732,0x32252936,0x342C232B,0x352B2630,0x372A2936,0x38292B3A,
@@ -779,7 +780,7 @@ const static DRAM_ATTR uint32_t ntsc_RGB332[256] = {
 };
 
 // PAL yuyv palette, must be in RAM
-const static DRAM_ATTR uint32_t pal_yuyv[] = {
+constexpr static DRAM_ATTR uint32_t pal_yuyv[512] = {
     0x18181818,0x1A16191E,0x1E121A26,0x21101A2C,0x1E1D1A1B,0x211B1A20,0x25171B29,0x27151C2E,
     0x25231B1E,0x27201C23,0x2B1D1D2B,0x2E1A1E31,0x2B281D20,0x2E261E26,0x31221F2E,0x34202034,
     0x322D1F23,0x342B2029,0x38282131,0x3A252137,0x38332126,0x3A30212B,0x3E2D2234,0x412A2339,
@@ -847,6 +848,26 @@ const static DRAM_ATTR uint32_t pal_yuyv[] = {
     0x454C3933,0x45493C38,0x46464040,0x47434246,0x47514035,0x474F433B,0x484B4643,0x49494949,
 };
 
+// The tables above are hand tuned. No linear function of red, green and
+// blue truncated to DAC levels reproduces all their samples, so the
+// compile-time generator in ESP_8_BIT_palette.h, used for custom palettes,
+// is checked to stay within one DAC step of them so custom palettes match
+// the stock colors. The generator itself is checked exactly against the
+// same math done at runtime in extras/test/test_tables.cpp.
+constexpr ESP_8_BIT_phase_table<256> ntsc_RGB332_generated =
+    ESP_8_BIT_ntscTable<ESP_8_BIT_RGB332, 4>(ESP_8_BIT_make_index_list<256>::type());
+constexpr ESP_8_BIT_phase_table<512> pal_yuyv_generated =
+    ESP_8_BIT_palTable<ESP_8_BIT_RGB332>(ESP_8_BIT_make_index_list<512>::type());
+static_assert(ESP_8_BIT_tables_close(ntsc_RGB332, ntsc_RGB332_generated.entry, 256, 1),
+    "Generated NTSC palette differs from ntsc_RGB332");
+static_assert(ESP_8_BIT_tables_close(pal_yuyv, pal_yuyv_generated.entry, 512, 1),
+    "Generated PAL palette differs from pal_yuyv");
+
+// No hand tuned table at 3 samples per color clock, generated from the
+// same calibration
+static const DRAM_ATTR ESP_8_BIT_phase_table<256> ntsc3_RGB332 =
+    ESP_8_BIT_ntscTable<ESP_8_BIT_RGB332, 3>(ESP_8_BIT_make_index_list<256>::type());
+
 //====================================================================================================
 //====================================================================================================
 
@@ -888,7 +909,7 @@ static uint8_t** _lines; // Front buffer currently on display
 static uint8_t** _backBuffer; // Back buffer waiting to be swapped to front
 
 // TRUE when _backBuffer is ready to go.
-static bool _swapReady;
+static volatile bool _swapReady;
 
 // Notification handle once front and back buffers have been swapped.
 static TaskHandle_t _swapCompleteNotify;
@@ -896,33 +917,223 @@ static TaskHandle_t _swapCompleteNotify;
 // Number of swaps completed
 static uint32_t _swap_counter = 0;
 
+// Active window: the picture is _window_width pixels by _window_lines lines
+// placed at _window_x, _window_y on screen, which is 256 pixels wide by
+// _active_lines lines. The rest of the screen is drawn in _border_color.
+// Everything drawn per line (frame buffer, tiles, display list, scroll,
+// sprites, line palettes) is in window coordinates.
+#define MAX_WINDOW_LINES ESP_8_BIT_MAX_WINDOW_LINES
+static int _window_x = 0;
+static int _window_y = 0;
+static int _window_width = 256;
+static int _window_lines = 240;
+static uint8_t _border_color = 0;
+static int _pal_first_line = 32;    // first active line of PAL field
+
+// Interlace: frame of two fields, the second starting half a line later
+// so its lines fall between those of the first. Field 0 shows even frame
+// lines, field 1 odd ones. With _fieldCallback the frame buffer holds
+// only even lines and the callback draws odd lines into _fieldLine.
+#define PAL_FIELD_LINES 286
+static bool _interlace = false;
+static int _field = 0;              // field being generated
+static int _field_first[2];         // first active line of each field
+static ESP_8_BIT_field_callback _fieldCallback = NULL;
+static void* _fieldCallbackArg = NULL;
+static DRAM_ATTR uint32_t _fieldLine[ESP_8_BIT_MAX_LINE_PIXELS/4];
+
+// Frame buffer resolution. Low resolution modes have the frame buffer at
+// half width and/or half height, doubled back up to 256x240 on the fly:
+// blit_double() draws each pixel twice as wide, and active_line() reads
+// each frame buffer line for two screen lines.
+static int _frameWidth = 256;
+static int _frameHeight = 240;
+static int _frameBytes = 256;   // bytes per frame buffer line
+static int _pixelShift = 0;     // 1 if pixels are doubled horizontally
+static int _lineShift = 0;      // 1 if lines are doubled vertically
+static DRAM_ATTR uint32_t _doubleLine[64];
+
+// Horizontal resolution. The screen is SCREEN_COLOR_CLOCKS wide, 256
+// pixels of 3 samples at 4 samples per color clock. Other widths use other
+// blit kernels: 160 and 192 pixels of one color clock, 320 and 384 pixels
+// of half a color clock. At 3 samples per color clock 256 pixels are 2
+// samples each, leaving a border, and there are no half color clock pixels.
+// _linePixels is pixels per line as blitted, after any doubling, and the
+// picture takes _pictureSamples samples starting _pictureStart samples
+// into the screen, which is _screenSamples wide.
+#define SCREEN_COLOR_CLOCKS 192
+#define MAX_LINE_PIXELS ESP_8_BIT_MAX_LINE_PIXELS
+static int _screenPixels = 256;     // pixels across whole screen width
+static int _samplesPerPixel = 3;
+static int _linePixels = 256;
+static int _pictureStart = 0;
+static int _pictureSamples = 768;
+static int _screenSamples = 768;
+
+// Monochrome: frame buffer of 1 or 2 bits per pixel, most significant
+// first, and each pixel one or two samples of luminance with no color
+// burst. _monoLut has the samples of every 4 bit nibble of the frame
+// buffer, _monoWords 32-bit words of them, from the gray levels of the
+// current palette.
+static bool _mono = false;
+static int _monoBits = 1;
+static int _monoWords = 2;
+static DRAM_ATTR uint32_t _monoLut[16][4];
+
+// Band presentation: frame buffer split into _bandCount horizontal bands
+// of _bandLines lines each. A bit set in _bandPending asks video_isr() to
+// swap that band's line pointers between front and back buffer as soon as
+// the line being generated is outside the band. _swapImmediate asks for a
+// whole buffer swap at the next line, tearing allowed.
+static int _bandCount = 1;
+static int _bandLines = 240;
+static volatile uint32_t _bandPending = 0;
+static volatile bool _swapImmediate = false;
+
+// Present-to-scanout latency, from the present call until video_isr()
+// generates the first line showing presented content. One per
+// ESP_8_BIT_present_mode, plus per band start times.
+struct present_latency {
+    uint32_t start;     // cycle count at present
+    int line;           // screen line that completes the measurement
+    bool armed;         // swap done, waiting for line
+    uint32_t sum_us;
+    uint32_t count;
+};
+static present_latency _latency[3];
+static uint32_t _bandPresentStart[ESP_8_BIT_MAX_BANDS];
+static uint32_t _bandScanoutPending = 0;
+
 volatile int _line_counter = 0;
 volatile uint32_t _frame_counter = 0;
+int _pal_phase;     // PAL V-switch and burst phase of the line, lowest bit
 
 int _active_lines;
 int _line_count;
 
 int _line_width;
-int _samples_per_cc;
+int _samples_per_cc = 4;
 const uint32_t* _palette;
 
-float _sample_rate;
-
 int _hsync;
 int _hsync_long;
 int _hsync_short;
+int _hsync_broad;
 int _burst_start;
 int _burst_width;
 int _active_start;
-
-int16_t* _burst0 = 0; // pal bursts
-int16_t* _burst1 = 0;
-
-static int usec(float us)
-{
-    uint32_t r = (uint32_t)(us*_sample_rate);
-    return ((r + _samples_per_cc)/(_samples_per_cc << 1))*(_samples_per_cc << 1);  // multiple of color clock, word align
-}
+int _line_cycles;
+
+
+// Per-line palette tables, one phase table pointer per frame buffer line.
+// NULL table or NULL entry means that line uses the default _palette.
+// Application edits _linePalettesBack, video_isr() copies it over to
+// _linePalettes during vertical blank once _linePalettesReady is set.
+static const uint32_t** _linePalettes = NULL;
+static const uint32_t** _linePalettesBack = NULL;
+static volatile bool _linePalettesReady = false;
+
+// Palette transform (brightness, invert, grayscale, tint) state. Derived
+// phase tables are built into a _transformPalettes[] buffer that is neither
+// on display nor already staged, then staged in _paletteNext to become
+// _palette at vblank. A third buffer lets a second change in the same frame
+// leave both of those alone.
+#define TRANSFORM_PALETTES 3
+static uint32_t* _transformPalettes[TRANSFORM_PALETTES] = {NULL, NULL, NULL};
+static const uint32_t* volatile _paletteNext = NULL;
+static volatile bool _paletteReady = false;
+static uint8_t _brightness = 255;
+static bool _invert = false;
+static bool _grayscale = false;
+static uint8_t _tintColor = 0;
+static uint8_t _tintAmount = 0;
+
+// Tile mode: when _tileMap is set there is no frame buffer. Each line is
+// assembled from 8x8 tiles into _tileLine by video_isr() right before it is
+// encoded. Scroll offset is staged in _tileScroll*Next until vblank.
+static uint8_t* _tileMap = NULL;
+static const uint8_t* _tileSet = NULL;
+static int _tileScrollX = 0;
+static int _tileScrollY = 0;
+static int _tileScrollXNext = 0;
+static int _tileScrollYNext = 0;
+static bool _tileScrollReady = false;
+static DRAM_ATTR uint32_t _tileLine[(ESP_8_BIT_TILE_MAP_WIDTH+1)*ESP_8_BIT_TILE_SIZE/4 + 1];
+static DRAM_ATTR uint32_t _tileLineAligned[ESP_8_BIT_TILE_MAP_WIDTH*ESP_8_BIT_TILE_SIZE/4];
+
+// Scroll registers: per screen line, which frame buffer line to show and
+// how many pixels to rotate it left. Staged in the *Next tables and
+// resolved into _lineSource/_lineScrollX at vblank, so video_isr() only
+// does a table lookup. NULL until the scroll API is first used.
+static int _scrollOriginNext = 0;
+static int16_t* _lineSourceNext = NULL;   // -1 to follow scroll origin
+static uint16_t* _lineScrollXNext = NULL;
+static bool _scrollReady = false;
+static int16_t* _lineSource = NULL;
+static uint16_t* _lineScrollX = NULL;
+static DRAM_ATTR uint32_t _scrollLine[MAX_LINE_PIXELS/4];
+
+// Display list: setDisplayList() copies the entries and expands them into
+// one dl_line per screen line, so active_line() does a single lookup. Two
+// tables, the one not on screen is filled and swapped in at vblank.
+struct dl_line {
+    uint8_t entry;      // index into entry[]
+    uint8_t row;        // line within entry
+    uint8_t color;      // SOLID and GRADIENT color of this line
+    uint8_t mode;
+};
+struct dl_table {
+    ESP_8_BIT_display_list_entry entry[ESP_8_BIT_MAX_DISPLAY_LIST];
+    dl_line line[MAX_WINDOW_LINES];
+};
+static dl_table* _displayListTables = NULL;  // both tables, NULL until used
+static dl_table* _displayList = NULL;        // NULL when showing frame buffer
+static dl_table* _displayListNext = NULL;
+static bool _displayListReady = false;
+static uint16_t* _prevLine = NULL;           // DMA buffer of last active line
+static uint8_t* _prevSrc = NULL;             // pixels of last active line
+static uint8_t _prevColor = 0;               // color of last line, if solid
+static bool _prevNarrow = false;             // last line was half width
+static DRAM_ATTR uint32_t _solidLine[MAX_LINE_PIXELS/4];
+
+// Raster callbacks, sorted by screen line. Application edits
+// _rasterStaged, video_isr() copies it over at vblank. Cycle counts cover
+// the whole ISR on lines with a callback, an overrun is such a line taking
+// longer than the line itself lasts.
+struct raster_entry {
+    int line;
+    ESP_8_BIT_raster_callback callback;
+    void* arg;
+};
+static raster_entry _raster[ESP_8_BIT_MAX_RASTER_CALLBACKS];
+static raster_entry _rasterStaged[ESP_8_BIT_MAX_RASTER_CALLBACKS];
+static int _rasterCount = 0;
+static int _rasterStagedCount = 0;
+static bool _rasterReady = false;
+static uint32_t _rasterCycles = 0;         // worst line of the frame in progress
+static uint32_t _rasterCyclesLastFrame = 0;
+static uint32_t _rasterOverrunCount = 0;
+
+// Sprite overlay: application edits _spritesNext, at vblank video_isr()
+// copies it to _sprites and rebuilds per-line lists of sprites to draw.
+// Each active line with sprites is copied to _spriteLine and the sprites
+// drawn over it before encoding, so frame buffer memory is never touched.
+struct sprite_entry {
+    const uint8_t* image;   // size*size RGB332 pixels, NULL if hidden
+    int16_t x;
+    int16_t y;
+    uint8_t size;
+    uint8_t transparent;
+};
+static sprite_entry* _sprites = NULL;
+static sprite_entry* _spritesNext = NULL;
+static bool _spritesReady = false;
+static uint8_t* _spriteLineCount = NULL;   // number of sprites on each line
+static uint8_t* _spriteLineList = NULL;    // ESP_8_BIT_SPRITES_PER_LINE indices per line
+static uint32_t _spriteDropCount = 0;
+static uint32_t _spriteCycles = 0;         // worst line of the frame in progress
+static uint32_t _spriteCyclesLastFrame = 0;
+static DRAM_ATTR uint32_t _spriteLine[MAX_LINE_PIXELS/4];
 
 #define NTSC_COLOR_CLOCKS_PER_SCANLINE 228       // really 227.5 for NTSC but want to avoid half phase fiddling for now
 #define NTSC_FREQUENCY (315000000.0/88)
@@ -931,29 +1142,190 @@ static int usec(float us)
 #define PAL_COLOR_CLOCKS_PER_SCANLINE 284        // really 283.75 ?
 #define PAL_FREQUENCY 4433618.75
 #define PAL_LINES 312
+#define PAL_BURST_WIDTH ((10*4 + 4) & 0xFFFE)
+
+//===================================================================================================
+//===================================================================================================
+// Signal timing, computed at compile time so begin() has no floating point math to do
+
+struct video_timing {
+    int samples_per_cc;
+    int line_width;
+    int line_count;
+    int hsync;
+    int hsync_long;
+    int hsync_short;
+    int hsync_broad;
+    int burst_start;
+    int burst_width;
+    int active_start;
+};
+
+// Samples in given microseconds at sample_rate (MHz), rounded to multiple of color clock, word aligned
+constexpr int usec(float us, float sample_rate, int samples_per_cc)
+{
+    return (((uint32_t)(us*sample_rate) + samples_per_cc)/(samples_per_cc << 1))*(samples_per_cc << 1);
+}
+
+constexpr float ntsc_sample_rate(int samples_per_cc)
+{
+    return 315.0/88 * samples_per_cc;   // DAC rate in mhz
+}
+
+constexpr video_timing ntsc_timing(int samples_per_cc)
+{
+    return {
+        samples_per_cc,
+        NTSC_COLOR_CLOCKS_PER_SCANLINE*samples_per_cc,
+        NTSC_LINES,
+        usec(4.7, ntsc_sample_rate(samples_per_cc), samples_per_cc),                            // hsync
+        usec(63.555-4.7, ntsc_sample_rate(samples_per_cc), samples_per_cc),                     // hsync_long
+        usec(2.3, ntsc_sample_rate(samples_per_cc), samples_per_cc),                            // hsync_short
+        usec(63.555/2-4.7, ntsc_sample_rate(samples_per_cc), samples_per_cc),                   // hsync_broad
+        0,                                                                                      // burst_start
+        0,                                                                                      // burst_width
+        usec(samples_per_cc == 4 ? 10 : 10.5, ntsc_sample_rate(samples_per_cc), samples_per_cc) // active_start
+    };
+}
+
+constexpr float pal_sample_rate(int samples_per_cc)
+{
+    return PAL_FREQUENCY*samples_per_cc/1000000.0;       // DAC rate in mhz
+}
+
+constexpr video_timing pal_timing(int samples_per_cc)
+{
+    return {
+        samples_per_cc,
+        PAL_COLOR_CLOCKS_PER_SCANLINE*samples_per_cc,
+        PAL_LINES,
+        usec(4.7, pal_sample_rate(samples_per_cc), samples_per_cc),     // hsync
+        usec(30, pal_sample_rate(samples_per_cc), samples_per_cc),      // hsync_long
+        usec(2, pal_sample_rate(samples_per_cc), samples_per_cc),       // hsync_short
+        usec(32-4.7, pal_sample_rate(samples_per_cc), samples_per_cc),  // hsync_broad
+        usec(5.6, pal_sample_rate(samples_per_cc), samples_per_cc),     // burst_start
+        PAL_BURST_WIDTH,                                                // burst_width
+        usec(10.4, pal_sample_rate(samples_per_cc), samples_per_cc)     // active_start
+    };
+}
+
+constexpr video_timing _ntsc3_timing = ntsc_timing(3);
+constexpr video_timing _ntsc4_timing = ntsc_timing(4);
+constexpr video_timing _pal4_timing = pal_timing(4);
+
+// Must match the values formerly computed at runtime by video_init()/pal_init(),
+// see also extras/test/test_tables.cpp. NTSC had no equalizing or broad
+// pulses before interlace, their widths are pinned as first generated.
+static_assert(_ntsc3_timing.line_width == 684 && _ntsc3_timing.active_start == 114, "NTSC 3x timing changed");
+static_assert(_ntsc3_timing.hsync == 48 && _ntsc3_timing.hsync_long == 630 &&
+    _ntsc3_timing.hsync_short == 24 && _ntsc3_timing.hsync_broad == 288, "NTSC 3x sync widths changed");
+static_assert(_ntsc4_timing.line_width == 912 && _ntsc4_timing.active_start == 144, "NTSC 4x timing changed");
+static_assert(_ntsc4_timing.hsync == 64 && _ntsc4_timing.hsync_long == 840 &&
+    _ntsc4_timing.hsync_short == 32 && _ntsc4_timing.hsync_broad == 384, "NTSC 4x sync widths changed");
+static_assert(_pal4_timing.line_width == 1136 && _pal4_timing.burst_start == 96 &&
+    _pal4_timing.burst_width == 44 && _pal4_timing.active_start == 184, "PAL timing changed");
+static_assert(_pal4_timing.hsync == 80 && _pal4_timing.hsync_long == 536 &&
+    _pal4_timing.hsync_short == 32 && _pal4_timing.hsync_broad == 488, "PAL sync widths changed");
+
+// 3 samples per color clock NTSC burst amplitude at 120 and 240 degrees
+constexpr int NTSC3_BURST_PHASE = 0.866025*BLANKING_LEVEL/2;
+static_assert(NTSC3_BURST_PHASE == 2217, "NTSC 3x burst amplitude changed");
+
+// PAL colorburst for even and odd lines, 4 samples per color clock
+struct pal_burst_table {
+    int16_t sample[PAL_BURST_WIDTH];
+};
+
+constexpr int16_t pal_burst_sample(int i, double offset)
+{
+    return BLANKING_LEVEL + ESP_8_BIT_sin(M_PI + i*(2*M_PI/4) + offset) * BLANKING_LEVEL/1.5;
+}
+
+template<int... I>
+constexpr pal_burst_table pal_burst(double offset, ESP_8_BIT_index_list<I...>)
+{
+    return {{ pal_burst_sample(I, offset)... }};
+}
+
+static const DRAM_ATTR pal_burst_table _burst0 = pal_burst(3*M_PI/4, ESP_8_BIT_make_index_list<PAL_BURST_WIDTH>::type());
+static const DRAM_ATTR pal_burst_table _burst1 = pal_burst(-3*M_PI/4, ESP_8_BIT_make_index_list<PAL_BURST_WIDTH>::type());
+
+// Must match the values formerly computed at runtime by pal_init(), every
+// sample is compared in extras/test/test_tables.cpp
+static_assert(pal_burst_sample(0, 3*M_PI/4) == 2706 && pal_burst_sample(1, 3*M_PI/4) == 7533 &&
+    pal_burst_sample(2, 3*M_PI/4) == 7533 && pal_burst_sample(3, 3*M_PI/4) == 2706 &&
+    pal_burst_sample(0, -3*M_PI/4) == 7533 && pal_burst_sample(1, -3*M_PI/4) == 7533 &&
+    pal_burst_sample(2, -3*M_PI/4) == 2706 && pal_burst_sample(3, -3*M_PI/4) == 2706 &&
+    pal_burst_sample(PAL_BURST_WIDTH-1, 3*M_PI/4) == 2706, "PAL burst changed");
+
+// Luminance of a phase table entry, the average of its samples
+static inline IRAM_ATTR uint32_t palette_luma(uint32_t color)
+{
+    if (_samples_per_cc == 3)
+        return ((P0 & 0xFF) + (P1 & 0xFF) + (P2 & 0xFF))/3;
+    return ((P0 & 0xFF) + (P1 & 0xFF) + (P2 & 0xFF) + (color & 0xFF) + 2)/4;
+}
 
-void pal_init();
+// Build _monoLut from the gray levels of _palette: colors 0x00 and 0xFF
+// at 1 bit per pixel, 0x00, 0x49, 0xB6 and 0xFF at 2
+static void IRAM_ATTR mono_lut()
+{
+    static const DRAM_ATTR uint8_t grays[2][4] = {{0x00, 0xFF}, {0x00, 0x49, 0xB6, 0xFF}};
+    uint16_t level[4];
+    for (int k = 0; k < (1 << _monoBits); k++)
+        level[k] = palette_luma(_palette[grays[_monoBits - 1][k]]) << 8;
+
+    int pixels = 4/_monoBits;
+    int repeat = 2*_monoWords/pixels;   // samples per pixel
+    for (int n = 0; n < 16; n++) {
+        uint16_t samples[8];
+        for (int p = 0; p < pixels; p++) {
+            int k = (n >> (4 - _monoBits*(p + 1))) & ((1 << _monoBits) - 1);
+            for (int r = 0; r < repeat; r++)
+                samples[p*repeat + r] = level[k];
+        }
+        for (int w = 0; w < _monoWords; w++)
+            _monoLut[n][w] = (samples[2*w] << 16) | samples[2*w + 1];
+    }
+}
 
 void video_init(int samples_per_cc, int ntsc)
 {
-    _samples_per_cc = samples_per_cc;
+    const video_timing& t = ntsc ? (samples_per_cc == 3 ? _ntsc3_timing : _ntsc4_timing) : _pal4_timing;
+
+    _samples_per_cc = t.samples_per_cc;
+    _line_width = t.line_width;
+    _line_count = t.line_count;
+    _hsync = t.hsync;
+    _hsync_long = t.hsync_long;
+    _hsync_short = t.hsync_short;
+    _hsync_broad = t.hsync_broad;
+    _burst_start = t.burst_start;
+    _burst_width = t.burst_width;
+    _active_start = t.active_start;
 
     if (ntsc) {
-        _sample_rate = 315.0/88 * samples_per_cc;   // DAC rate
-        _line_width = NTSC_COLOR_CLOCKS_PER_SCANLINE*samples_per_cc;
-        _line_count = NTSC_LINES;
-        _hsync_long = usec(63.555-4.7);
-        _active_start = usec(samples_per_cc == 4 ? 10 : 10.5);
-        _hsync = usec(4.7);
-        _palette = ntsc_RGB332;
+        _palette = samples_per_cc == 3 ? ntsc3_RGB332.entry : ntsc_RGB332;
         _pal_ = 0;
     } else {
-        pal_init();
         _palette = pal_yuyv;
         _pal_ = 1;
     }
 
+    // PAL has room for more lines, grow the active area around the center
     _active_lines = 240;
+    if (!ntsc && _window_y + _window_lines > _active_lines)
+        _active_lines = _window_y + _window_lines;
+    _pal_first_line = 32 - (_active_lines - 240)/2;
+    if (_interlace) {
+        // Twice the lines plus one, so every field starts with a half line
+        _line_count = 2*_line_count + 1;
+        _field_first[0] = ntsc ? 21 : 23 + (PAL_FIELD_LINES - _active_lines)/2;
+        _field_first[1] = _field_first[0] + (ntsc ? 263 : 313);
+    }
+    if (_mono)
+        mono_lut();
+    _line_cycles = ntsc ? 15253 : 15360;    // 63.556us or 64us at 240MHz, as us()
     video_init_hw(_line_width,_samples_per_cc);    // init the hardware
 }
 
@@ -961,38 +1333,13 @@ void video_init(int samples_per_cc, int ntsc)
 //===================================================================================================
 // PAL
 
-void pal_init()
-{
-    int cc_width = 4;
-    _sample_rate = PAL_FREQUENCY*cc_width/1000000.0;       // DAC rate in mhz
-    _line_width = PAL_COLOR_CLOCKS_PER_SCANLINE*cc_width;
-    _line_count = PAL_LINES;
-    _hsync_short = usec(2);
-    _hsync_long = usec(30);
-    _hsync = usec(4.7);
-    _burst_start = usec(5.6);
-    _burst_width = (int)(10*cc_width + 4) & 0xFFFE;
-    _active_start = usec(10.4);
-
-    // make colorburst tables for even and odd lines
-    _burst0 = new int16_t[_burst_width];
-    _burst1 = new int16_t[_burst_width];
-    float phase = 2*M_PI/2;
-    for (int i = 0; i < _burst_width; i++)
-    {
-        _burst0[i] = BLANKING_LEVEL + sin(phase + 3*M_PI/4) * BLANKING_LEVEL/1.5;
-        _burst1[i] = BLANKING_LEVEL + sin(phase - 3*M_PI/4) * BLANKING_LEVEL/1.5;
-        phase += 2*M_PI/cc_width;
-    }
-}
-
-void IRAM_ATTR blit_pal(uint8_t* src, uint16_t* dst)
+void IRAM_ATTR blit_pal(uint8_t* src, uint16_t* dst, const uint32_t* palette)
 {
     uint32_t c,color;
-    bool even = _line_counter & 1;
-    const uint32_t* p = even ? _palette : _palette + 256;
+    bool even = _pal_phase & 1;
+    const uint32_t* p = even ? palette : palette + 256;
     int left = 0;
-    int right = 256;
+    int right = _linePixels;
     uint8_t mask = 0xFF;
 
     // 192 of 288 color clocks wide: roughly correct aspect ratio
@@ -1025,7 +1372,7 @@ void IRAM_ATTR blit_pal(uint8_t* src, uint16_t* dst)
 void IRAM_ATTR burst_pal(uint16_t* line)
 {
     line += _burst_start;
-    int16_t* b = (_line_counter & 1) ? _burst0 : _burst1;
+    const int16_t* b = (_pal_phase & 1) ? _burst0.sample : _burst1.sample;
     for (int i = 0; i < _burst_width; i += 2) {
         line[i^1] = b[i];
         line[(i+1)^1] = b[i+1];
@@ -1047,27 +1394,211 @@ void IRAM_ATTR burst_pal(uint16_t* line)
 #define END_TIMING() t = cpu_ticks() - t; _blit_ticks_min = min(_blit_ticks_min,t); _blit_ticks_max = max(_blit_ticks_max,t);
 #define ISR_BEGIN() uint32_t t = cpu_ticks()
 #define ISR_END() t = cpu_ticks() - t;_isr_us += (t+120)/240;
+#define BEGIN_TILE_TIMING()  uint32_t t = cpu_ticks()
+#define END_TILE_TIMING() t = cpu_ticks() - t; _tile_ticks_max = max(_tile_ticks_max,t);
 uint32_t _blit_ticks_min = 0;
 uint32_t _blit_ticks_max = 0;
+uint32_t _tile_ticks_max = 0;
 uint32_t _isr_us = 0;
 #else
+#define BEGIN_TILE_TIMING()
+#define END_TILE_TIMING()
 #define BEGIN_TIMING()
 #define END_TIMING()
 #define ISR_BEGIN()
 #define ISR_END()
 #endif
 
+// draw a 160 or 192 pixel line, one pixel per color clock. Each pixel
+// gets all 4 samples of its palette entry, so PAL and NTSC share this.
+void IRAM_ATTR blit_cc(uint8_t* src, uint16_t* dst, const uint32_t* p)
+{
+    uint32_t color,c;
+    uint32_t mask = 0xFF;
+    int i;
+
+    if (_pal_) {
+        if (!(_pal_phase & 1))
+            p += 256;
+        dst += 88;
+    }
+
+    // AAAA BBBB CCCC DDDD
+    // 4 pixels, 4 color clocks, 16 samples
+    for (i = 0; i < _linePixels; i += 4) {
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        dst[0^1] = P0;
+        dst[1^1] = P1;
+        dst[2^1] = P2;
+        dst[3^1] = P3;
+        color = p[(c >> 8) & mask];
+        dst[4^1] = P0;
+        dst[5^1] = P1;
+        dst[6^1] = P2;
+        dst[7^1] = P3;
+        color = p[(c >> 16) & mask];
+        dst[8^1] = P0;
+        dst[9^1] = P1;
+        dst[10^1] = P2;
+        dst[11^1] = P3;
+        color = p[(c >> 24) & mask];
+        dst[12^1] = P0;
+        dst[13^1] = P1;
+        dst[14^1] = P2;
+        dst[15^1] = P3;
+        dst += 16;
+    }
+}
+
+// draw a 320 or 384 pixel line, two pixels per color clock. Each pixel
+// gets the 2 samples of its palette entry at its place in the color clock.
+void IRAM_ATTR blit_half_cc(uint8_t* src, uint16_t* dst, const uint32_t* p)
+{
+    uint32_t color,c;
+    uint32_t mask = 0xFF;
+    int i;
+
+    if (_pal_) {
+        if (!(_pal_phase & 1))
+            p += 256;
+        dst += 88;
+    }
+
+    // AB CD
+    // 4 pixels, 2 color clocks, 8 samples
+    for (i = 0; i < _linePixels; i += 4) {
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        dst[0^1] = P0;
+        dst[1^1] = P1;
+        color = p[(c >> 8) & mask];
+        dst[2^1] = P2;
+        dst[3^1] = P3;
+        color = p[(c >> 16) & mask];
+        dst[4^1] = P0;
+        dst[5^1] = P1;
+        color = p[(c >> 24) & mask];
+        dst[6^1] = P2;
+        dst[7^1] = P3;
+        dst += 8;
+    }
+}
+
+// 3 samples per color clock: phase table entries hold samples at 0, 120
+// and 240 degrees, then 0 again. Words of two samples, first sample in the
+// upper half, starting at each phase:
+#define W01 ((color & 0xFFFF0000) | ((color >> 8) & 0xFFFF))
+#define W12 (((color << 8) & 0xFFFF0000) | (color & 0xFFFF))
+#define W20 ((color << 16) | ((color << 8) & 0xFFFF))
+
+// draw a 256 pixel line at 3 samples per color clock, 3 pixels over 2 color
+// clocks. Each pixel gets 2 samples, one 32-bit store. Picture starts at
+// phase 0, 12 pixels bring it back there.
+void IRAM_ATTR blit_ntsc3(uint8_t* src, uint16_t* dst, const uint32_t* p)
+{
+    uint32_t color,c;
+    uint32_t mask = 0xFF;
+    uint32_t* d = (uint32_t*)dst;
+    int i;
+
+    // AA BB CC DD
+    // 4 pixels, 8 samples, phase moves on by 2 samples
+    for (i = 0; i < _linePixels; ) {
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        d[0] = W01;
+        color = p[(c >> 8) & mask];
+        d[1] = W20;
+        color = p[(c >> 16) & mask];
+        d[2] = W12;
+        color = p[(c >> 24) & mask];
+        d[3] = W01;
+        if ((i += 4) >= _linePixels)
+            break;
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        d[4] = W20;
+        color = p[(c >> 8) & mask];
+        d[5] = W12;
+        color = p[(c >> 16) & mask];
+        d[6] = W01;
+        color = p[(c >> 24) & mask];
+        d[7] = W20;
+        if ((i += 4) >= _linePixels)
+            break;
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        d[8] = W12;
+        color = p[(c >> 8) & mask];
+        d[9] = W01;
+        color = p[(c >> 16) & mask];
+        d[10] = W20;
+        color = p[(c >> 24) & mask];
+        d[11] = W12;
+        i += 4;
+        d += 12;
+    }
+}
+
+// draw a 160 or 192 pixel line at 3 samples per color clock, one pixel per
+// color clock
+void IRAM_ATTR blit_cc_ntsc3(uint8_t* src, uint16_t* dst, const uint32_t* p)
+{
+    uint32_t color,c;
+    uint32_t mask = 0xFF;
+    int i;
+
+    // AAA BBB CCC DDD
+    // 4 pixels, 4 color clocks, 12 samples
+    for (i = 0; i < _linePixels; i += 4) {
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        dst[0^1] = P0;
+        dst[1^1] = P1;
+        dst[2^1] = P2;
+        color = p[(c >> 8) & mask];
+        dst[3^1] = P0;
+        dst[4^1] = P1;
+        dst[5^1] = P2;
+        color = p[(c >> 16) & mask];
+        dst[6^1] = P0;
+        dst[7^1] = P1;
+        dst[8^1] = P2;
+        color = p[(c >> 24) & mask];
+        dst[9^1] = P0;
+        dst[10^1] = P1;
+        dst[11^1] = P2;
+        dst += 12;
+    }
+}
+
 // draw a line of game in NTSC
-void IRAM_ATTR blit(uint8_t* src, uint16_t* dst)
+void IRAM_ATTR blit(uint8_t* src, uint16_t* dst, const uint32_t* p)
 {
-    const uint32_t* p = _palette;
     uint32_t color,c;
     uint32_t mask = 0xFF;
     int i;
 
     BEGIN_TIMING();
+    if (_samples_per_cc == 3) {
+        if (_samplesPerPixel == 3)
+            blit_cc_ntsc3(src,dst,p);
+        else
+            blit_ntsc3(src,dst,p);
+        END_TIMING();
+        return;
+    }
+    if (_samplesPerPixel != 3) {
+        if (_samplesPerPixel == 4)
+            blit_cc(src,dst,p);
+        else
+            blit_half_cc(src,dst,p);
+        END_TIMING();
+        return;
+    }
     if (_pal_) {
-        blit_pal(src,dst);
+        blit_pal(src,dst,p);
         END_TIMING();
         return;
     }
@@ -1075,7 +1606,7 @@ void IRAM_ATTR blit(uint8_t* src, uint16_t* dst)
     // AAA ABB BBC CCC
     // 4 pixels, 3 color clocks, 4 samples per cc
     // each pixel gets 3 samples, 192 color clocks wide
-    for (i = 0; i < 256; i += 4) {
+    for (i = 0; i < _linePixels; i += 4) {
         c = *((uint32_t*)(src+i));
         color = p[c & mask];
         dst[0^1] = P0;
@@ -1099,14 +1630,128 @@ void IRAM_ATTR blit(uint8_t* src, uint16_t* dst)
     END_TIMING();
 }
 
+// draw a 128 pixel line doubled to full width. Each pixel takes 6 samples,
+// so one palette lookup serves two screen pixels. Sample phases work out
+// the same as blit() of a line with every pixel doubled.
+void IRAM_ATTR blit_double(uint8_t* src, uint16_t* dst, const uint32_t* p)
+{
+    uint32_t color,c;
+    uint32_t mask = 0xFF;
+    int i;
+
+    BEGIN_TIMING();
+    if (_pal_) {
+        if (!(_pal_phase & 1))
+            p += 256;
+        dst += 88;
+    }
+
+    // AAA AAA BBB BBB CCC CCC DDD DDD
+    // 4 pixels, 6 color clocks, 24 samples
+    for (i = 0; i < _linePixels/2; i += 4) {
+        c = *((uint32_t*)(src+i));
+        color = p[c & mask];
+        dst[0^1] = P0;
+        dst[1^1] = P1;
+        dst[2^1] = P2;
+        dst[3^1] = P3;
+        dst[4^1] = P0;
+        dst[5^1] = P1;
+        color = p[(c >> 8) & mask];
+        dst[6^1] = P2;
+        dst[7^1] = P3;
+        dst[8^1] = P0;
+        dst[9^1] = P1;
+        dst[10^1] = P2;
+        dst[11^1] = P3;
+        color = p[(c >> 16) & mask];
+        dst[12^1] = P0;
+        dst[13^1] = P1;
+        dst[14^1] = P2;
+        dst[15^1] = P3;
+        dst[16^1] = P0;
+        dst[17^1] = P1;
+        color = p[(c >> 24) & mask];
+        dst[18^1] = P2;
+        dst[19^1] = P3;
+        dst[20^1] = P0;
+        dst[21^1] = P1;
+        dst[22^1] = P2;
+        dst[23^1] = P3;
+        dst += 24;
+    }
+
+    END_TIMING();
+}
+
+// draw a monochrome line. Each nibble of the frame buffer is 4 pixels at
+// 1 bit or 2 pixels at 2 bits, copied as 1, 2 or 4 words of samples from
+// _monoLut: no palette lookup and no color clock phase to follow.
+void IRAM_ATTR blit_mono(uint8_t* src, uint16_t* dst)
+{
+    uint32_t b;
+    int i;
+
+    BEGIN_TIMING();
+    if (_pal_)
+        dst += 88;
+
+    uint32_t* d = (uint32_t*)dst;
+    switch (_monoWords) {
+        case 1:
+            // 2 bits, 1 sample per pixel
+            for (i = 0; i < _frameBytes; i++) {
+                b = src[i];
+                d[0] = _monoLut[b >> 4][0];
+                d[1] = _monoLut[b & 0xF][0];
+                d += 2;
+            }
+            break;
+        case 2:
+            // 1 bit, 1 sample or 2 bits, 2 samples per pixel
+            for (i = 0; i < _frameBytes; i++) {
+                b = src[i];
+                const uint32_t* hi = _monoLut[b >> 4];
+                const uint32_t* lo = _monoLut[b & 0xF];
+                d[0] = hi[0];
+                d[1] = hi[1];
+                d[2] = lo[0];
+                d[3] = lo[1];
+                d += 4;
+            }
+            break;
+        default:
+            // 1 bit, 2 samples per pixel
+            for (i = 0; i < _frameBytes; i++) {
+                b = src[i];
+                const uint32_t* hi = _monoLut[b >> 4];
+                const uint32_t* lo = _monoLut[b & 0xF];
+                d[0] = hi[0];
+                d[1] = hi[1];
+                d[2] = hi[2];
+                d[3] = hi[3];
+                d[4] = lo[0];
+                d[5] = lo[1];
+                d[6] = lo[2];
+                d[7] = lo[3];
+                d += 8;
+            }
+            break;
+    }
+
+    END_TIMING();
+}
+
 void IRAM_ATTR burst(uint16_t* line)
 {
+    if (_mono)
+        return;     // no chroma, receiver falls back to black and white
     if (_pal_) {
         burst_pal(line);
         return;
     }
 
-    int i,phase;
+    int i;
     switch (_samples_per_cc) {
         case 4:
             // 4 samples per color clock
@@ -1119,14 +1764,13 @@ void IRAM_ATTR burst(uint16_t* line)
             break;
         case 3:
             // 3 samples per color clock
-            phase = 0.866025*BLANKING_LEVEL/2;
             for (i = _hsync; i < _hsync + (3*10); i += 6) {
                 line[i+1] = BLANKING_LEVEL;
-                line[i+0] = BLANKING_LEVEL + phase;
-                line[i+3] = BLANKING_LEVEL - phase;
+                line[i+0] = BLANKING_LEVEL + NTSC3_BURST_PHASE;
+                line[i+3] = BLANKING_LEVEL - NTSC3_BURST_PHASE;
                 line[i+2] = BLANKING_LEVEL;
-                line[i+5] = BLANKING_LEVEL + phase;
-                line[i+4] = BLANKING_LEVEL - phase;
+                line[i+5] = BLANKING_LEVEL + NTSC3_BURST_PHASE;
+                line[i+4] = BLANKING_LEVEL - NTSC3_BURST_PHASE;
             }
             break;
     }
@@ -1168,77 +1812,695 @@ void IRAM_ATTR pal_sync(uint16_t* line, int i)
     pal_sync2(line+_line_width/2,_line_width/2, t & 1);
 }
 
-// Wait for front and back buffers to swap before starting drawing
-void video_sync()
+// Interlaced vertical sync is made of half lines, each starting with an
+// equalizing pulse, a broad pulse, a normal hsync or nothing
+enum { HALF_E, HALF_B, HALF_N, HALF_X };
+#define HALF_LINES(a,b) ((HALF_##a << 2) | HALF_##b)
+
+void IRAM_ATTR half_line(uint16_t* line, int type)
 {
-  if (!_lines)
-    return;
-  ulTaskNotifyTake(pdTRUE, 0);
+    int swidth = type == HALF_E ? _hsync_short : type == HALF_B ? _hsync_broad : type == HALF_N ? _hsync : 0;
+    int i;
+    for (i = 0; i < swidth; i++)
+        line[i] = SYNC_LEVEL;
+    for (; i < _line_width/2; i++)
+        line[i] = BLANKING_LEVEL;
 }
 
-// Workhorse ISR handles audio and video updates
-extern "C"
-void IRAM_ATTR video_isr(const volatile void* vbuf)
-{
-    if (!_lines)
-        return;
+// Sync lines of both fields, 0 based line numbers
+// http://martin.hinner.info/vga/pal.html
+static const DRAM_ATTR uint8_t _ntsc_field0_sync[9] = {     // lines 0-8
+    HALF_LINES(E,E), HALF_LINES(E,E), HALF_LINES(E,E),
+    HALF_LINES(B,B), HALF_LINES(B,B), HALF_LINES(B,B),
+    HALF_LINES(E,E), HALF_LINES(E,E), HALF_LINES(E,E)
+};
+static const DRAM_ATTR uint8_t _ntsc_field1_sync[10] = {    // lines 262-271
+    HALF_LINES(N,E), HALF_LINES(E,E), HALF_LINES(E,E), HALF_LINES(E,B),
+    HALF_LINES(B,B), HALF_LINES(B,B), HALF_LINES(B,E),
+    HALF_LINES(E,E), HALF_LINES(E,E), HALF_LINES(E,X)
+};
+static const DRAM_ATTR uint8_t _pal_field0_sync[8] = {      // lines 622-624, 0-4
+    HALF_LINES(N,E), HALF_LINES(E,E), HALF_LINES(E,E),
+    HALF_LINES(B,B), HALF_LINES(B,B), HALF_LINES(B,E),
+    HALF_LINES(E,E), HALF_LINES(E,E)
+};
+static const DRAM_ATTR uint8_t _pal_field1_sync[8] = {      // lines 310-317
+    HALF_LINES(E,E), HALF_LINES(E,E), HALF_LINES(E,B),
+    HALF_LINES(B,B), HALF_LINES(B,B),
+    HALF_LINES(E,E), HALF_LINES(E,E), HALF_LINES(E,X)
+};
 
-    ISR_BEGIN();
+// Palette for given frame buffer line, honoring per-line palette table
+static inline IRAM_ATTR const uint32_t* line_palette(int y)
+{
+    if (_linePalettes && _linePalettes[y])
+        return _linePalettes[y];
+    return _palette;
+}
 
-    int i = _line_counter++;
-    uint16_t* buf = (uint16_t*)vbuf;
-    if (_pal_) {
-        // pal
-        if (i < 32) {
-            blanking(buf,false);                // pre render/black 0-32
-        } else if (i < _active_lines + 32) {    // active video 32-272
-            sync(buf,_hsync);
-            burst(buf);
-            blit(_lines[i-32],buf + _active_start);
-        } else if (i < 304) {                   // post render/black 272-304
-            blanking(buf,false);
-        } else {
-            pal_sync(buf,i);                    // 8 lines of sync 304-312
-        }
-    } else {
-        // ntsc
-        if (i < _active_lines) {                // active video
-            sync(buf,_hsync);
-            burst(buf);
-            blit(_lines[i],buf + _active_start);
+// Apply staged palette and per-line palette table updates, called
+// during vertical blank
+static void IRAM_ATTR vblank_palettes()
+{
+    if (_paletteReady) {
+        // Clear first, a table staged meanwhile is applied next vblank
+        _paletteReady = false;
+        _palette = _paletteNext;
+        if (_mono)
+            mono_lut();
+    }
+    if (_linePalettesReady) {
+        for (int y = 0; y < _window_lines; y++)
+            _linePalettes[y] = _linePalettesBack[y];
+        _linePalettesReady = false;
+    }
+}
 
-        } else if (i < (_active_lines + 5)) {   // post render/black
-            blanking(buf,false);
+// Apply staged tile scroll offset, called during vertical blank
+static void IRAM_ATTR vblank_tiles()
+{
+    if (_tileScrollReady) {
+        _tileScrollX = _tileScrollXNext;
+        _tileScrollY = _tileScrollYNext;
+        _tileScrollReady = false;
+    }
+}
 
-        } else if (i < (_active_lines + 8)) {   // vsync
-            blanking(buf,true);
+// Copy one pixel row of count tiles into _tileLine. Tiles are looked up in
+// mapRow starting at mapX, wrapping around at the map width.
+static void IRAM_ATTR tile_copy(const uint8_t* tileRow, const uint8_t* mapRow, int mapX, int count)
+{
+    uint32_t* dst = _tileLine;
+    for (int i = 0; i < count; i++) {
+        const uint32_t* src = (const uint32_t*)(tileRow + mapRow[mapX]*ESP_8_BIT_TILE_BYTES);
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst += 2;
+        mapX = (mapX + 1) & (ESP_8_BIT_TILE_MAP_WIDTH - 1);
+    }
+}
 
-        } else {                                // pre render/black
-            blanking(buf,false);
-        }
+// Assemble visible line y from the tile map. One map lookup and two word
+// copies per tile (33 tiles to cover fine scroll) then, only if scrolled
+// by a non-multiple of 4 pixels, a word-wise realign so blit() can keep
+// doing aligned 32-bit reads.
+static uint8_t* IRAM_ATTR tile_line(int y)
+{
+    BEGIN_TILE_TIMING();
+
+    int mapY = y + _tileScrollY;
+    if (mapY >= ESP_8_BIT_TILE_MAP_HEIGHT*ESP_8_BIT_TILE_SIZE)
+        mapY -= ESP_8_BIT_TILE_MAP_HEIGHT*ESP_8_BIT_TILE_SIZE;
+    const uint8_t* mapRow = _tileMap + (mapY / ESP_8_BIT_TILE_SIZE)*ESP_8_BIT_TILE_MAP_WIDTH;
+    const uint8_t* tileRow = _tileSet + (mapY % ESP_8_BIT_TILE_SIZE)*ESP_8_BIT_TILE_SIZE;
+    tile_copy(tileRow, mapRow, _tileScrollX / ESP_8_BIT_TILE_SIZE, ESP_8_BIT_TILE_MAP_WIDTH + 1);
+
+    int fine = _tileScrollX % ESP_8_BIT_TILE_SIZE;
+    uint8_t* line = (uint8_t*)_tileLine + (fine & ~3);
+    if (fine & 3) {
+        int shift = (fine & 3)*8;
+        const uint32_t* src = (const uint32_t*)line;
+        for (int i = 0; i < ESP_8_BIT_TILE_MAP_WIDTH*ESP_8_BIT_TILE_SIZE/4; i++)
+            _tileLineAligned[i] = (src[i] >> shift) | (src[i+1] << (32 - shift));
+        line = (uint8_t*)_tileLineAligned;
     }
 
-    if (_line_counter == _line_count) {
+    END_TILE_TIMING();
+    return line;
+}
+
+// Resolve staged scroll origin and line remap into the tables read by
+// active_line(), called during vertical blank
+static void IRAM_ATTR vblank_scroll()
+{
+    if (!_scrollReady)
+        return;
+
+    int source = _scrollOriginNext;
+    for (int y = 0; y < _window_lines; y++) {
+        _lineSource[y] = _lineSourceNext[y] < 0 ? source : _lineSourceNext[y];
+        _lineScrollX[y] = _lineScrollXNext[y];
+        if (++source == _window_lines)
+            source = 0;
+    }
+    _scrollReady = false;
+}
+
+// Rotate line left by offset pixels with wrap into _scrollLine. Done word
+// at a time, with a funnel shift when offset is not a multiple of 4, so
+// blit() keeps its aligned 32-bit reads.
+static uint8_t* IRAM_ATTR scroll_line(uint8_t* src, int offset)
+{
+    const int words = _linePixels/4;
+    const uint32_t* s32 = (const uint32_t*)src;
+    int w = offset >> 2;
+    int shift = (offset & 3)*8;
+
+    if (shift) {
+        uint32_t next = s32[w];
+        for (int i = 0; i < words; i++) {
+            uint32_t c = next;
+            if (++w == words)
+                w = 0;
+            next = s32[w];
+            _scrollLine[i] = (c >> shift) | (next << (32 - shift));
+        }
+    } else {
+        for (int i = 0; i < words; i++) {
+            _scrollLine[i] = s32[w];
+            if (++w == words)
+                w = 0;
+        }
+    }
+    return (uint8_t*)_scrollLine;
+}
+
+// Apply staged sprite table and rebuild per-line sprite lists, called
+// during vertical blank. Lower sprite index is drawn on top, and once a
+// line holds ESP_8_BIT_SPRITES_PER_LINE sprites the rest are dropped.
+static void IRAM_ATTR vblank_sprites()
+{
+    if (!_spritesReady)
+        return;
+
+    for (int i = 0; i < ESP_8_BIT_MAX_SPRITES; i++)
+        _sprites[i] = _spritesNext[i];
+    _spritesReady = false;
+
+    for (int y = 0; y < _window_lines; y++)
+        _spriteLineCount[y] = 0;
+    for (int i = 0; i < ESP_8_BIT_MAX_SPRITES; i++) {
+        const sprite_entry& s = _sprites[i];
+        if (!s.image)
+            continue;
+        int top = s.y < 0 ? 0 : s.y;
+        int bottom = s.y + s.size > _window_lines ? _window_lines : s.y + s.size;
+        for (int y = top; y < bottom; y++) {
+            if (_spriteLineCount[y] < ESP_8_BIT_SPRITES_PER_LINE)
+                _spriteLineList[y*ESP_8_BIT_SPRITES_PER_LINE + _spriteLineCount[y]++] = i;
+            else
+                _spriteDropCount++;
+        }
+    }
+}
+
+// Copy line into _spriteLine and draw that line's sprites over it. List is
+// walked backwards so lower sprite indices land on top.
+static uint8_t* IRAM_ATTR sprite_line(uint8_t* src, int y)
+{
+    uint32_t t = cpu_ticks();
+
+    const uint32_t* s32 = (const uint32_t*)src;
+    for (int i = 0; i < _linePixels/4; i++)
+        _spriteLine[i] = s32[i];
+
+    uint8_t* dst = (uint8_t*)_spriteLine;
+    const uint8_t* list = _spriteLineList + y*ESP_8_BIT_SPRITES_PER_LINE;
+    for (int n = _spriteLineCount[y] - 1; n >= 0; n--) {
+        const sprite_entry& s = _sprites[list[n]];
+        const uint8_t* row = s.image + (y - s.y)*s.size;
+        int left = s.x < 0 ? -s.x : 0;
+        int right = s.x + s.size > _linePixels ? _linePixels - s.x : s.size;
+        for (int i = left; i < right; i++) {
+            if (row[i] != s.transparent)
+                dst[s.x + i] = row[i];
+        }
+    }
+
+    t = cpu_ticks() - t;
+    if (t > _spriteCycles)
+        _spriteCycles = t;
+    return dst;
+}
+
+// Whether any line of display list table shows frame buffer lines
+static bool display_list_uses_frame_buffer(const dl_table* table)
+{
+    for (const dl_line& l : table->line) {
+        if (l.mode == ESP_8_BIT_DL_BITMAP && NULL == table->entry[l.entry].data)
+            return true;
+    }
+    return false;
+}
+
+// Apply staged display list, called during vertical blank
+static void IRAM_ATTR vblank_display_list()
+{
+    if (_displayListReady) {
+        _displayList = _displayListNext;
+        _displayListReady = false;
+    }
+}
+
+// Phase table entry for color c on the line being generated
+static inline IRAM_ATTR uint32_t line_color(const uint32_t* palette, uint8_t c)
+{
+    if (_pal_ && !(_pal_phase & 1))
+        palette += 256;
+    if (_mono)
+        return palette_luma(palette[c])*0x01010101;
+    return palette[c];
+}
+
+// First sample of the 256 pixel wide screen area within line buffer
+static inline IRAM_ATTR uint16_t* screen_start(uint16_t* buf)
+{
+    return buf + _active_start + (_pal_ ? 88 : 0);
+}
+
+// Fill samples from start of screen with one phase table entry. A solid
+// span's samples just repeat every color clock, so no per-pixel lookup is
+// needed. At 4 samples per color clock start and samples are multiples of
+// 4, at 3 they are even and spans may start at any phase.
+static void IRAM_ATTR solid_span(uint16_t* screen, int start, uint32_t color, int samples)
+{
+    if (_samples_per_cc == 3) {
+        uint16_t s[3] = {(uint16_t)P0, (uint16_t)P1, (uint16_t)P2};
+        int phase = start % 3;
+        for (int i = start; i < start + samples; i++) {
+            screen[i^1] = s[phase];
+            if (++phase == 3)
+                phase = 0;
+        }
+        return;
+    }
+
+    uint32_t w0 = ((color >> 8) & 0xFFFF) | (color & 0xFFFF0000);  // P1, P0
+    uint32_t w1 = ((color << 8) & 0xFFFF) | (color << 16);         // P3, P2
+    uint32_t* d = (uint32_t*)(screen + start);
+    for (int i = 0; i < samples/2; i += 2) {
+        d[i] = w0;
+        d[i+1] = w1;
+    }
+}
+
+// Fill screen left and right of the window with border color
+static void IRAM_ATTR border_columns(uint16_t* buf)
+{
+    uint16_t* screen = screen_start(buf);
+    uint32_t color = line_color(_palette, _border_color);
+    solid_span(screen, 0, color, _pictureStart);
+    solid_span(screen, _pictureStart + _pictureSamples, color, _screenSamples - _pictureStart - _pictureSamples);
+}
+
+// Line above or below the window, all border color
+static void IRAM_ATTR border_line(uint16_t* buf)
+{
+    sync(buf,_hsync);
+    burst(buf);
+    solid_span(screen_start(buf), 0, line_color(_palette, _border_color), _screenSamples);
+}
+
+// Double each pixel of a 128 pixel line into _doubleLine, for lines that
+// need scrolling or sprites applied at full width, and for all lines at 3
+// samples per color clock which has no doubling blit kernel
+static uint8_t* IRAM_ATTR double_pixels(uint8_t* src)
+{
+    const uint32_t* s32 = (const uint32_t*)src;
+    for (int i = 0; i < _linePixels/8; i++) {
+        uint32_t c = s32[i];
+        uint32_t lo = (c & 0xFF) | ((c & 0xFF00) << 8);
+        uint32_t hi = ((c >> 16) & 0xFF) | ((c >> 8) & 0xFF0000);
+        _doubleLine[2*i] = lo | (lo << 8);
+        _doubleLine[2*i+1] = hi | (hi << 8);
+    }
+    return (uint8_t*)_doubleLine;
+}
+
+// Fill _solidLine with one color, for solid lines that need sprites on top
+static uint8_t* IRAM_ATTR solid_pixels(uint8_t c)
+{
+    uint32_t c4 = c*0x01010101;
+    for (int i = 0; i < _linePixels/4; i++)
+        _solidLine[i] = c4;
+    return (uint8_t*)_solidLine;
+}
+
+// Pixels of window line y from frame buffer, or from field callback for
+// odd lines of an interlaced frame
+static inline IRAM_ATTR uint8_t* frame_line(int y)
+{
+    if (!_interlace)
+        return _lines[y >> _lineShift];
+    if (!_fieldCallback)
+        return _lines[2*y + _field];
+    if (!_field)
+        return _lines[y];
+    _fieldCallback(2*y + 1, (uint8_t*)_fieldLine, _fieldCallbackArg);
+    return (uint8_t*)_fieldLine;
+}
+
+// Pixels of line y per display list, or NULL if it was fully encoded into
+// buf on a fast path
+static uint8_t* IRAM_ATTR display_list_line(uint16_t* buf, int y, bool& narrow)
+{
+    const dl_line& l = _displayList->line[y];
+    bool sprites = _spriteLineCount && _spriteLineCount[y];
+
+    switch (l.mode) {
+        case ESP_8_BIT_DL_BITMAP: {
+            const ESP_8_BIT_display_list_entry& e = _displayList->entry[l.entry];
+            if (e.data)
+                return (uint8_t*)e.data + l.row*_screenPixels;
+            narrow = _pixelShift;
+            return frame_line((e.source << _lineShift) + l.row);
+        }
+        case ESP_8_BIT_DL_TEXT: {
+            const ESP_8_BIT_display_list_entry& e = _displayList->entry[l.entry];
+            const uint8_t* mapRow = e.data + (l.row / ESP_8_BIT_TILE_SIZE)*ESP_8_BIT_TILE_MAP_WIDTH;
+            tile_copy(e.tiles + (l.row % ESP_8_BIT_TILE_SIZE)*ESP_8_BIT_TILE_SIZE, mapRow, 0, ESP_8_BIT_TILE_MAP_WIDTH);
+            return (uint8_t*)_tileLine;
+        }
+        case ESP_8_BIT_DL_REPEAT:
+            // NTSC lines all share burst phase, so the line above can be
+            // copied sample for sample. PAL alternates, so re-encode it.
+            if (!_pal_ && _prevLine && !sprites) {
+                const uint32_t* s = (const uint32_t*)_prevLine;
+                uint32_t* d = (uint32_t*)buf;
+                for (int i = 0; i < _line_width/2; i++)
+                    d[i] = s[i];
+                return NULL;
+            }
+            narrow = _prevNarrow;
+            return _prevSrc ? _prevSrc : solid_pixels(_prevColor);
+        default:
+            if (sprites)
+                return solid_pixels(l.color);
+            sync(buf,_hsync);
+            burst(buf);
+            solid_span(screen_start(buf),_pictureStart,line_color(line_palette(y),l.color),_pictureSamples);
+            if (_pictureSamples < _screenSamples)
+                border_columns(buf);
+            _prevSrc = NULL;
+            _prevColor = l.color;
+            return NULL;
+    }
+}
+
+// Encode active video line y: sync, burst and picture
+static void IRAM_ATTR active_line(uint16_t* buf, int y)
+{
+    // From here on y is within window
+    y -= _window_y;
+    if ((unsigned)y >= (unsigned)_window_lines) {
+        border_line(buf);
+        return;
+    }
+
+    if (y == 0) {
+        _prevLine = NULL;
+        _prevSrc = NULL;
+        _prevColor = 0;
+    }
+
+    if (_mono) {
+        sync(buf,_hsync);
+        blit_mono(frame_line(_lineSource ? _lineSource[y] : y), buf + _active_start + _pictureStart);
+        if (_pictureSamples < _screenSamples)
+            border_columns(buf);
+        return;
+    }
+
+    uint8_t* src;
+    bool repeat = false;
+    bool narrow = false;
+    if (_displayList) {
+        repeat = _displayList->line[y].mode == ESP_8_BIT_DL_REPEAT;
+        src = display_list_line(buf, y, narrow);
+        if (!src) {
+            _prevLine = buf;
+            return;
+        }
+    } else {
+        int line = _lineSource ? _lineSource[y] : y;
+        if (_tileMap) {
+            src = tile_line(line);
+        } else {
+            src = frame_line(line);
+            narrow = _pixelShift;
+        }
+    }
+
+    sync(buf,_hsync);
+    burst(buf);
+
+    bool scroll = _lineSource && _lineScrollX[y] && !repeat;
+    bool sprites = _spriteLineCount && _spriteLineCount[y];
+    if (narrow && (scroll || sprites || _samples_per_cc == 3)) {
+        src = double_pixels(src);
+        narrow = false;
+    }
+    if (scroll)
+        src = scroll_line(src, _lineScrollX[y]);
+    _prevSrc = src;
+    _prevNarrow = narrow;
+    if (sprites)
+        src = sprite_line(src, y);
+
+    uint16_t* dst = buf + _active_start + _pictureStart;
+    if (narrow)
+        blit_double(src,dst,line_palette(y));
+    else
+        blit(src,dst,line_palette(y));
+    if (_pictureSamples < _screenSamples)
+        border_columns(buf);
+    _prevLine = buf;
+}
+
+// Apply staged raster callback table, called during vertical blank
+static void IRAM_ATTR vblank_raster()
+{
+    if (!_rasterReady)
+        return;
+
+    for (int n = 0; n < _rasterStagedCount; n++)
+        _raster[n] = _rasterStaged[n];
+    _rasterCount = _rasterStagedCount;
+    _rasterReady = false;
+}
+
+// Run raster callbacks registered for screen line y, which video_isr()
+// started working on at cycle count lineStart
+static void IRAM_ATTR raster_line(int y, uint32_t lineStart)
+{
+    for (int n = 0; n < _rasterCount && _raster[n].line <= y; n++) {
+        if (_raster[n].line == y) {
+            _raster[n].callback(y, _raster[n].arg);
+
+            uint32_t t = cpu_ticks() - lineStart;
+            if (t > _rasterCycles)
+                _rasterCycles = t;
+            if (t > (uint32_t)_line_cycles)
+                _rasterOverrunCount++;
+            return;
+        }
+    }
+}
+
+// Swap front and back buffers and wake the task waiting on it. Single
+// buffered interlaced frames have nothing to swap.
+static void IRAM_ATTR swap_buffers()
+{
+    if (_bufferB) {
+      if (_lines == _bufferA) {
+        _lines = _bufferB;
+        _backBuffer = _bufferA;
+      } else {
+        _lines = _bufferA;
+        _backBuffer = _bufferB;
+      }
+    }
+    _swapReady = false;
+    // Pending bands are still in the buffer just swapped in, so they are
+    // presented along with it
+    _bandScanoutPending |= _bandPending;
+    _bandPending = 0;
+    _swap_counter++;
+
+    // Signal video_sync() swap has completed
+    vTaskNotifyGiveFromISR(
+        _swapCompleteNotify,
+        NULL);
+}
+
+static void IRAM_ATTR latency_done(present_latency& l, uint32_t now, uint32_t start)
+{
+    l.sum_us += (now - start)/240;
+    l.count++;
+}
+
+// Swap pending bands the line being generated is not in, then complete
+// latency measurements of presents whose first line is screen line y
+static void IRAM_ATTR present_line(int y)
+{
+    uint32_t now = cpu_ticks();
+
+    if (_swapImmediate) {
+        swap_buffers();
+        _swapImmediate = false;
+        _latency[ESP_8_BIT_PRESENT_IMMEDIATE].line = (y >= 0 && y < _active_lines) ? y : 0;
+        _latency[ESP_8_BIT_PRESENT_IMMEDIATE].armed = true;
+    }
+
+    uint32_t pending = _bandPending;
+    if (pending) {
+        for (int b = 0; b < _bandCount; b++) {
+            int first = b*_bandLines;
+            if (!(pending & (1 << b)) || (y >= first && y < first + _bandLines))
+                continue;
+            for (int k = first; k < first + _bandLines; k++) {
+                uint8_t* line = _lines[k];
+                _lines[k] = _backBuffer[k];
+                _backBuffer[k] = line;
+            }
+            pending &= ~(1 << b);
+            _bandScanoutPending |= 1 << b;
+        }
+        if (pending != _bandPending) {
+            _bandPending = pending;
+            vTaskNotifyGiveFromISR(_swapCompleteNotify, NULL);
+        }
+    }
+
+    if (y < 0 || y >= _active_lines)
+        return;
+    if (_bandScanoutPending && y % _bandLines == 0 && (_bandScanoutPending & (1 << (y/_bandLines))) &&
+        !(_bandPending & (1 << (y/_bandLines)))) {
+        latency_done(_latency[ESP_8_BIT_PRESENT_BAND], now, _bandPresentStart[y/_bandLines]);
+        _bandScanoutPending &= ~(1 << (y/_bandLines));
+    }
+    for (int m = 0; m < 3; m++) {
+        present_latency& l = _latency[m];
+        if (l.armed && l.line == y) {
+            latency_done(l, now, l.start);
+            l.armed = false;
+        }
+    }
+}
+
+// Line i of an interlaced frame: sync lines per field sync tables, active
+// lines of whichever field i is in, blank otherwise
+static void IRAM_ATTR interlace_line(uint16_t* buf, int i)
+{
+    int t = -1;
+    if (_pal_) {
+        if (i < 5)
+            t = _pal_field0_sync[i + 3];
+        else if (i >= 622)
+            t = _pal_field0_sync[i - 622];
+        else if (i >= 310 && i < 318)
+            t = _pal_field1_sync[i - 310];
+    } else {
+        if (i < 9)
+            t = _ntsc_field0_sync[i];
+        else if (i >= 262 && i < 272)
+            t = _ntsc_field1_sync[i - 262];
+    }
+    if (t >= 0) {
+        half_line(buf,t >> 2);
+        half_line(buf + _line_width/2,t & 3);
+        return;
+    }
+
+    _field = i >= _field_first[1];
+    int y = i - _field_first[_field];
+    if (y >= 0 && y < _active_lines)
+        active_line(buf,y);
+    else
+        blanking(buf,false);
+}
+
+// Wait for front and back buffers to swap before starting drawing.
+// video_isr() notifies after swapping at vertical blank.
+void video_sync()
+{
+  if (!_lines && !_tileMap && !_displayList)
+    return;
+  while (_swapReady)
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+// Workhorse ISR handles audio and video updates
+extern "C"
+void IRAM_ATTR video_isr(const volatile void* vbuf)
+{
+    if (!_lines && !_tileMap && !_displayList)
+        return;
+
+    ISR_BEGIN();
+    uint32_t lineStart = cpu_ticks();
+
+    int i = _line_counter++;
+    uint16_t* buf = (uint16_t*)vbuf;
+    // Odd line count of interlaced frames would repeat PAL phase at frame
+    // start, keep it alternating
+    _pal_phase = _interlace ? _line_counter + _frame_counter : _line_counter;
+
+    // Screen line numbering starts at the first active line in all modes
+    int first = _interlace ? _field_first[0] : _pal_ ? _pal_first_line : 0;
+    if (_lines)
+        present_line(i - first);
+    if (_interlace) {
+        interlace_line(buf,i);
+    } else if (_pal_) {
+        // pal
+        // _active_lines of 240 to 288 are centered on lines 32-272
+        if (i < _pal_first_line) {
+            blanking(buf,false);                // pre render/black 0-32, 0-8 at most
+        } else if (i < _active_lines + _pal_first_line) {   // active video 32-272, 8-296 at most
+            active_line(buf,i-_pal_first_line);
+        } else if (i < 304) {                   // post render/black 272-304, 296-304 at most
+            blanking(buf,false);
+        } else {
+            pal_sync(buf,i);                    // 8 lines of sync 304-312
+        }
+    } else {
+        // ntsc
+        if (i < _active_lines) {                // active video
+            active_line(buf,i);
+
+        } else if (i < (_active_lines + 5)) {   // post render/black
+            blanking(buf,false);
+
+        } else if (i < (_active_lines + 8)) {   // vsync
+            blanking(buf,true);
+
+        } else {                                // pre render/black
+            blanking(buf,false);
+        }
+    }
+
+    if (_rasterCount) {
+        // Raster lines count from the first active line of the field being
+        // sent, lines before it belong to the end of the previous field
+        int y = i - first;
+        if (_interlace && i >= _field_first[1])
+            y = i - _field_first[1];
+        else if (y < 0)
+            y += _line_count - (_interlace ? _field_first[1] - first : 0);
+        raster_line(y, lineStart);
+    }
+
+    if (_line_counter == _line_count) {
         _line_counter = 0;                      // frame is done
         _frame_counter++;
 
+        vblank_palettes();
+        vblank_tiles();
+        vblank_scroll();
+        vblank_sprites();
+        vblank_raster();
+        vblank_display_list();
+        _spriteCyclesLastFrame = _spriteCycles;
+        _spriteCycles = 0;
+        _rasterCyclesLastFrame = _rasterCycles;
+        _rasterCycles = 0;
+
         // Is the back buffer ready to go?
         if (_swapReady) {
-          // Swap front and back buffers
-          if (_lines == _bufferA) {
-            _lines = _bufferB;
-            _backBuffer = _bufferA;
-          } else {
-            _lines = _bufferA;
-            _backBuffer = _bufferB;
-          }
-          _swapReady = false;
-          _swap_counter++;
-
-          // Signal video_sync() swap has completed
-            vTaskNotifyGiveFromISR(
-                _swapCompleteNotify,
-                NULL);
+          swap_buffers();
+          _latency[ESP_8_BIT_PRESENT_FRAME].line = 0;
+          _latency[ESP_8_BIT_PRESENT_FRAME].armed = true;
         }
     }
 
@@ -1304,8 +2566,65 @@ ESP_8_BIT_composite::~ESP_8_BIT_composite()
     periph_module_disable(PERIPH_I2S0_MODULE);
     _started = false;
   }
+  for (int i = 0; i < TRANSFORM_PALETTES; i++)
+  {
+    if (_transformPalettes[i])
+    {
+      heap_caps_free(_transformPalettes[i]);
+      _transformPalettes[i] = NULL;
+    }
+  }
+  _paletteReady = false;
+  if (_linePalettes)
+  {
+    delete[] _linePalettes;
+    delete[] _linePalettesBack;
+    _linePalettes = NULL;
+    _linePalettesBack = NULL;
+    _linePalettesReady = false;
+  }
   _lines = NULL;
   _backBuffer = NULL;
+  _tileMap = NULL;
+  _tileSet = NULL;
+  if (_lineSource)
+  {
+    delete[] _lineSource;
+    delete[] _lineSourceNext;
+    delete[] _lineScrollX;
+    delete[] _lineScrollXNext;
+    _lineSource = NULL;
+    _lineSourceNext = NULL;
+    _lineScrollX = NULL;
+    _lineScrollXNext = NULL;
+    _scrollOriginNext = 0;
+    _scrollReady = false;
+  }
+  _rasterCount = 0;
+  _rasterStagedCount = 0;
+  _rasterReady = false;
+  if (_displayListTables)
+  {
+    delete[] _displayListTables;
+    _displayListTables = NULL;
+    _displayList = NULL;
+    _displayListNext = NULL;
+  }
+  _displayListReady = false;
+  _prevLine = NULL;
+  _prevSrc = NULL;
+  if (_sprites)
+  {
+    delete[] _sprites;
+    delete[] _spritesNext;
+    delete[] _spriteLineCount;
+    delete[] _spriteLineList;
+    _sprites = NULL;
+    _spritesNext = NULL;
+    _spriteLineCount = NULL;
+    _spriteLineList = NULL;
+    _spritesReady = false;
+  }
   _instance_ = NULL;
 }
 
@@ -1335,18 +2654,38 @@ void ESP_8_BIT_composite::begin()
   }
   _started = true;
 
-  _bufferA = frameBufferAlloc();
-  _bufferB = frameBufferAlloc();
+  // Display list set up front may not need a frame buffer
+  bool frameBuffer = (NULL == _tileMap);
+  if (_displayListReady && _displayListNext)
+  {
+    frameBuffer = display_list_uses_frame_buffer(_displayListNext);
+    // Video is not running yet, apply right away
+    _displayList = _displayListNext;
+    _displayListReady = false;
+  }
+
+  if (frameBuffer)
+  {
+    _bufferA = frameBufferAlloc();
+    // Whole interlaced frame is drawn in place, no room to double buffer
+    if (!_interlace || _fieldCallback)
+    {
+      _bufferB = frameBufferAlloc();
+    }
+  }
 
   _lines = _bufferA;
-  _backBuffer = _bufferB;
+  _backBuffer = _bufferB ? _bufferB : _bufferA;
 
   // Initialize double-buffering infrastructure
   _swapReady = false;
+  _bandPending = 0;
+  _swapImmediate = false;
+  memset(_latency, 0, sizeof(_latency));
   _swapCompleteNotify = xTaskGetCurrentTaskHandle();
 
   // Start video signal generator
-  video_init(4, !_pal_);
+  video_init(_samples_per_cc, !_pal_);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1364,6 +2703,9 @@ void ESP_8_BIT_composite::begin()
 //
 // 14 extra allocations * 16 byte overhead = 224 extra bytes, worth it.
 
+//
+// Low resolution modes keep 4kB chunks, holding more of the shorter lines.
+
 const uint16_t linesPerFrame = 240;
 const uint16_t bytesPerLine = 256;
 const uint16_t linesPerChunk = 16;
@@ -1378,27 +2720,29 @@ uint8_t** ESP_8_BIT_composite::frameBufferAlloc()
   uint8_t** lineArray = NULL;
   uint8_t*  lineChunk = NULL;
   uint8_t*  lineStep  = NULL;
+  int chunkLines = chunkSize/_frameBytes;
 
-  lineArray = new uint8_t*[linesPerFrame];
+  lineArray = new uint8_t*[_frameHeight];
   if ( NULL == lineArray )
   {
     ESP_LOGE(TAG, "Frame lines array allocation fail");
     ESP_ERROR_CHECK(ESP_FAIL);
   }
 
-  for (uint8_t chunk = 0; chunk < chunksPerFrame; chunk++)
+  for (int chunkStart = 0; chunkStart < _frameHeight; chunkStart += chunkLines)
   {
-    lineChunk = new uint8_t[chunkSize];
+    int lines = min(chunkLines, _frameHeight - chunkStart);
+    lineChunk = new uint8_t[lines*_frameBytes];
     if ( NULL == lineChunk )
     {
       ESP_LOGE(TAG, "Frame buffer chunk allocation fail");
       ESP_ERROR_CHECK(ESP_FAIL);
     }
     lineStep = lineChunk;
-    for (uint8_t lineIndex = 0; lineIndex < linesPerChunk; lineIndex++)
+    for (int lineIndex = 0; lineIndex < lines; lineIndex++)
     {
-      lineArray[(chunk*linesPerChunk)+lineIndex] = lineStep;
-      lineStep += bytesPerLine;
+      lineArray[chunkStart+lineIndex] = lineStep;
+      lineStep += _frameBytes;
     }
   }
 
@@ -1410,9 +2754,11 @@ uint8_t** ESP_8_BIT_composite::frameBufferAlloc()
  */
 void ESP_8_BIT_composite::frameBufferFree(uint8_t** lineArray)
 {
-  for (uint8_t chunk = 0; chunk < chunksPerFrame; chunk++)
+  int chunkLines = chunkSize/_frameBytes;
+
+  for (int chunkStart = 0; chunkStart < _frameHeight; chunkStart += chunkLines)
   {
-    free(lineArray[chunk*linesPerChunk]);
+    free(lineArray[chunkStart]);
   }
   free(lineArray);
 }
@@ -1424,6 +2770,10 @@ void ESP_8_BIT_composite::waitForFrame()
 {
   instance_check();
 
+  if (!_swapReady)
+  {
+    _latency[ESP_8_BIT_PRESENT_FRAME].start = cpu_ticks();
+  }
   _swapReady = true;
 
   video_sync();
@@ -1454,3 +2804,1124 @@ uint32_t ESP_8_BIT_composite::getBufferSwapCount()
 {
   return _swap_counter;
 }
+
+/*
+ * @brief Default palette phase table for the current video standard
+ */
+const uint32_t* ESP_8_BIT_composite::getDefaultPalette()
+{
+  if (_pal_)
+  {
+    return pal_yuyv;
+  }
+  return _samples_per_cc == 3 ? ntsc3_RGB332.entry : ntsc_RGB332;
+}
+
+/*
+ * @brief Use a different palette for a horizontal band of lines
+ */
+void ESP_8_BIT_composite::setLinePalette(int firstLine, int lineCount, const uint32_t* palette)
+{
+  instance_check();
+
+  if (firstLine < 0 || lineCount < 0 || firstLine + lineCount > _window_lines)
+  {
+    ESP_LOGE(TAG, "Line palette band %d+%d out of range", firstLine, lineCount);
+    return;
+  }
+  if (_mono)
+  {
+    ESP_LOGE(TAG, "Line palettes are not available in monochrome mode");
+    return;
+  }
+
+  if (NULL == _linePalettes)
+  {
+    const uint32_t** linePalettes = new const uint32_t*[MAX_WINDOW_LINES];
+    const uint32_t** linePalettesBack = new const uint32_t*[MAX_WINDOW_LINES];
+    if (NULL == linePalettes || NULL == linePalettesBack)
+    {
+      ESP_LOGE(TAG, "Line palette table allocation fail");
+      ESP_ERROR_CHECK(ESP_FAIL);
+    }
+    for (int y = 0; y < MAX_WINDOW_LINES; y++)
+    {
+      linePalettes[y] = NULL;
+      linePalettesBack[y] = NULL;
+    }
+    // Publish last, video_isr() checks this to see if line palettes are in use.
+    _linePalettesBack = linePalettesBack;
+    _linePalettes = linePalettes;
+  }
+
+  for (int y = firstLine; y < firstLine + lineCount; y++)
+  {
+    _linePalettesBack[y] = palette;
+  }
+}
+
+/*
+ * @brief Apply line palette changes at the next vertical blank
+ */
+void ESP_8_BIT_composite::commitLinePalettes()
+{
+  instance_check();
+
+  if (_linePalettes)
+  {
+    _linePalettesReady = true;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Palette transform notes
+//
+// Each palette entry holds the DAC levels of 4 samples spanning one color
+// clock. Their average is luminance and the deviation of each sample from
+// that average is chrominance. So a whole-screen effect can be applied by
+// rewriting the phase table (256 or 512 entries) rather than every pixel
+// of the frame buffer:
+//
+// * Grayscale drops chrominance.
+// * Tint blends chrominance toward that of the tint color's entry.
+// * Invert mirrors luminance between black and white levels and negates
+//   chrominance, which is a 180 degree hue shift to the complementary color.
+// * Brightness scales luminance (relative to black) and chrominance together.
+
+// Black and white levels as they appear in palette phase tables
+#define PALETTE_BLACK ((int)(BLACK_LEVEL >> 8))
+#define PALETTE_WHITE ((int)(WHITE_LEVEL >> 8))
+
+// Scale value by fraction/255, rounding away from zero
+static int scale255(int value, int fraction)
+{
+  int scaled = value * fraction;
+  return (scaled >= 0 ? scaled + 127 : scaled - 127) / 255;
+}
+
+// Apply current transform settings to one palette entry. Tint is the
+// untransformed entry of the tint color, from the same half of the table.
+// At 3 samples per color clock the last byte repeats the first sample of
+// the next color clock, so only the first 3 count toward luminance.
+static uint32_t transform_entry(uint32_t entry, uint32_t tint)
+{
+  int samples = _samples_per_cc;
+  int sample[4];
+  int tintSample[4];
+  int luma = 0;
+  int tintLuma = 0;
+  for (int i = 0; i < samples; i++)
+  {
+    sample[i] = (entry >> (i*8)) & 0xFF;
+    tintSample[i] = (tint >> (i*8)) & 0xFF;
+    luma += sample[i];
+    tintLuma += tintSample[i];
+  }
+  luma = (luma + samples/2) / samples;
+  tintLuma = (tintLuma + samples/2) / samples;
+
+  // Tint is strongest at mid gray and fades out toward black and white, so
+  // those stay neutral and levels can't overshoot.
+  int tintStrength = luma - PALETTE_BLACK;
+  if (PALETTE_WHITE - luma < tintStrength)
+  {
+    tintStrength = PALETTE_WHITE - luma;
+  }
+  tintStrength = tintStrength < 0 ? 0 : tintStrength;
+
+  int newLuma = _invert ? PALETTE_BLACK + PALETTE_WHITE - luma : luma;
+  newLuma = PALETTE_BLACK + scale255(newLuma - PALETTE_BLACK, _brightness);
+
+  uint32_t result = 0;
+  for (int i = 0; i < samples; i++)
+  {
+    int chroma = _grayscale ? 0 : sample[i] - luma;
+    int tintChroma = (tintSample[i] - tintLuma) * tintStrength * 2 / (PALETTE_WHITE - PALETTE_BLACK);
+    chroma += scale255(tintChroma - chroma, _tintAmount);
+    if (_invert)
+    {
+      chroma = -chroma;
+    }
+    int level = newLuma + scale255(chroma, _brightness);
+    level = level < 0 ? 0 : (level > 0xFF ? 0xFF : level);
+    result |= (uint32_t)level << (i*8);
+  }
+  if (3 == samples)
+  {
+    result |= (result & 0xFF) << 24;
+  }
+  return result;
+}
+
+/*
+ * @brief Rebuild the transformed palette and stage it for next vertical blank
+ */
+void ESP_8_BIT_composite::applyPaletteTransform()
+{
+  const uint32_t* base = getDefaultPalette();
+
+  if (255 == _brightness && !_invert && !_grayscale && 0 == _tintAmount)
+  {
+    // No transform, go straight back to the stock palette.
+    _paletteNext = base;
+    _paletteReady = true;
+    return;
+  }
+
+  // video_isr() may be showing one table and about to swap in the staged
+  // one, build into neither
+  int entries = _pal_ ? 512 : 256;
+  const uint32_t* staged = _paletteNext;
+  uint32_t* target = NULL;
+  for (int i = 0; i < TRANSFORM_PALETTES && NULL == target; i++)
+  {
+    if (NULL == _transformPalettes[i])
+    {
+      _transformPalettes[i] = (uint32_t*)heap_caps_malloc(entries*sizeof(uint32_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_32BIT);
+      if (NULL == _transformPalettes[i])
+      {
+        ESP_LOGE(TAG, "Palette transform table allocation fail");
+        ESP_ERROR_CHECK(ESP_FAIL);
+      }
+    }
+    if (_transformPalettes[i] != _palette && _transformPalettes[i] != staged)
+    {
+      target = _transformPalettes[i];
+    }
+  }
+
+  for (int i = 0; i < entries; i++)
+  {
+    uint32_t tint = base[(i & 0x100) | _tintColor];
+    target[i] = transform_entry(base[i], tint);
+  }
+
+  _paletteNext = target;
+  _paletteReady = true;
+}
+
+/*
+ * @brief Scale brightness of the whole picture
+ */
+void ESP_8_BIT_composite::setBrightness(uint8_t brightness)
+{
+  instance_check();
+  _brightness = brightness;
+  applyPaletteTransform();
+}
+
+/*
+ * @brief Swap every color on screen for its inverse
+ */
+void ESP_8_BIT_composite::setInvert(bool invert)
+{
+  instance_check();
+  _invert = invert;
+  applyPaletteTransform();
+}
+
+/*
+ * @brief Remove color from the picture, leaving luminance only
+ */
+void ESP_8_BIT_composite::setGrayscale(bool grayscale)
+{
+  instance_check();
+  _grayscale = grayscale;
+  applyPaletteTransform();
+}
+
+/*
+ * @brief Blend color of the whole picture toward the given color
+ */
+void ESP_8_BIT_composite::setTint(uint8_t color, uint8_t amount)
+{
+  instance_check();
+  _tintColor = color;
+  _tintAmount = amount;
+  applyPaletteTransform();
+}
+
+/*
+ * @brief Switch to tile mode, where the screen is drawn from a tile map
+ * instead of a frame buffer
+ */
+void ESP_8_BIT_composite::setTileMode(const uint8_t* tileSet, uint8_t* tileMap)
+{
+  instance_check();
+
+  if (_started)
+  {
+    ESP_LOGE(TAG, "setTileMode() must be called before begin().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_frameWidth != bytesPerLine || _frameHeight != linesPerFrame || _interlace)
+  {
+    ESP_LOGE(TAG, "Tile mode is only available at 256x240 progressive.");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (NULL == tileSet || NULL == tileMap || ((uintptr_t)tileSet & 3))
+  {
+    ESP_LOGE(TAG, "Tile set must be non-NULL and 32-bit aligned, tile map non-NULL.");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  _tileSet = tileSet;
+  _tileMap = tileMap;
+  _tileScrollX = _tileScrollXNext = 0;
+  _tileScrollY = _tileScrollYNext = 0;
+  _tileScrollReady = false;
+}
+
+/*
+ * @brief Scroll the tile map, taking effect at next vertical blank
+ */
+void ESP_8_BIT_composite::setTileScroll(int x, int y)
+{
+  instance_check();
+
+  const int mapPixelsX = ESP_8_BIT_TILE_MAP_WIDTH*ESP_8_BIT_TILE_SIZE;
+  const int mapPixelsY = ESP_8_BIT_TILE_MAP_HEIGHT*ESP_8_BIT_TILE_SIZE;
+
+  _tileScrollXNext = ((x % mapPixelsX) + mapPixelsX) % mapPixelsX;
+  _tileScrollYNext = ((y % mapPixelsY) + mapPixelsY) % mapPixelsY;
+  _tileScrollReady = true;
+}
+
+/*
+ * @brief Allocate scroll register tables on first use, starting with an
+ * unscrolled identity mapping
+ */
+void ESP_8_BIT_composite::scrollAlloc()
+{
+  if (_lineSource)
+  {
+    return;
+  }
+
+  _lineSourceNext = new int16_t[MAX_WINDOW_LINES];
+  _lineScrollXNext = new uint16_t[MAX_WINDOW_LINES];
+  _lineScrollX = new uint16_t[MAX_WINDOW_LINES];
+  int16_t* lineSource = new int16_t[MAX_WINDOW_LINES];
+  if (NULL == _lineSourceNext || NULL == _lineScrollXNext || NULL == _lineScrollX || NULL == lineSource)
+  {
+    ESP_LOGE(TAG, "Scroll table allocation fail");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  for (int y = 0; y < MAX_WINDOW_LINES; y++)
+  {
+    _lineSourceNext[y] = -1;
+    _lineScrollXNext[y] = 0;
+    _lineScrollX[y] = 0;
+    lineSource[y] = y;
+  }
+  // Publish last, video_isr() checks this to see if scrolling is in use.
+  _lineSource = lineSource;
+}
+
+/*
+ * @brief Set vertical scroll origin, staged until commitScroll()
+ */
+void ESP_8_BIT_composite::setScrollY(int originY)
+{
+  instance_check();
+  scrollAlloc();
+
+  _scrollOriginNext = ((originY % _window_lines) + _window_lines) % _window_lines;
+}
+
+/*
+ * @brief Show a band of frame buffer lines on the given screen lines,
+ * staged until commitScroll()
+ */
+void ESP_8_BIT_composite::setLineSource(int firstLine, int lineCount, int sourceLine)
+{
+  instance_check();
+
+  if (firstLine < 0 || lineCount < 0 || firstLine + lineCount > _window_lines ||
+      sourceLine < -1 || sourceLine + lineCount > _window_lines)
+  {
+    ESP_LOGE(TAG, "Line source band %d+%d from %d out of range", firstLine, lineCount, sourceLine);
+    return;
+  }
+  scrollAlloc();
+
+  for (int i = 0; i < lineCount; i++)
+  {
+    _lineSourceNext[firstLine + i] = sourceLine < 0 ? -1 : sourceLine + i;
+  }
+}
+
+/*
+ * @brief Set horizontal scroll of a band of screen lines, staged until
+ * commitScroll()
+ */
+void ESP_8_BIT_composite::setLineScrollX(int firstLine, int lineCount, int offsetX)
+{
+  instance_check();
+
+  if (firstLine < 0 || lineCount < 0 || firstLine + lineCount > _window_lines)
+  {
+    ESP_LOGE(TAG, "Line scroll band %d+%d out of range", firstLine, lineCount);
+    return;
+  }
+  if (_mono)
+  {
+    ESP_LOGE(TAG, "Horizontal line scroll is not available in monochrome mode");
+    return;
+  }
+  scrollAlloc();
+
+  for (int y = firstLine; y < firstLine + lineCount; y++)
+  {
+    _lineScrollXNext[y] = ((offsetX % _linePixels) + _linePixels) % _linePixels;
+  }
+}
+
+/*
+ * @brief Apply scroll changes at the next vertical blank
+ */
+void ESP_8_BIT_composite::commitScroll()
+{
+  instance_check();
+
+  if (_lineSource)
+  {
+    _scrollReady = true;
+  }
+}
+
+// Blend RGB332 colors a and b, weight 0 to 255 toward b
+static uint8_t blend_rgb332(uint8_t a, uint8_t b, int weight)
+{
+  int red = (a >> 5) + ((int)(b >> 5) - (a >> 5))*weight/255;
+  int green = ((a >> 2) & 7) + ((int)((b >> 2) & 7) - ((a >> 2) & 7))*weight/255;
+  int blue = (a & 3) + ((int)(b & 3) - (a & 3))*weight/255;
+  return (red << 5) | (green << 2) | blue;
+}
+
+/*
+ * @brief Describe the screen with a display list, applied at the next
+ * vertical blank
+ */
+void ESP_8_BIT_composite::setDisplayList(const ESP_8_BIT_display_list_entry* list, int count)
+{
+  instance_check();
+
+  if (NULL == list)
+  {
+    count = 0;
+  }
+  if (count < 0 || count > ESP_8_BIT_MAX_DISPLAY_LIST)
+  {
+    ESP_LOGE(TAG, "Display list of %d entries too long", count);
+    return;
+  }
+  if (_mono && count)
+  {
+    ESP_LOGE(TAG, "Display list is not available in monochrome mode");
+    return;
+  }
+  if (0 == count && _started && NULL == _lines && NULL == _tileMap)
+  {
+    // video_isr() would have nothing left to show, not even sync
+    ESP_LOGE(TAG, "Display list is all there is to show without a frame buffer");
+    return;
+  }
+
+  int lines = 0;
+  for (int n = 0; n < count; n++)
+  {
+    const ESP_8_BIT_display_list_entry& e = list[n];
+    bool frameBufferLine = e.mode == ESP_8_BIT_DL_BITMAP && NULL == e.data;
+    if (e.mode > ESP_8_BIT_DL_REPEAT ||
+        (frameBufferLine && e.source + ((e.lines + _lineShift) >> _lineShift) > (_window_lines >> _lineShift)) ||
+        (frameBufferLine && _started && NULL == _lines) ||
+        (e.mode == ESP_8_BIT_DL_BITMAP && ((uintptr_t)e.data & 3)) ||
+        (e.mode == ESP_8_BIT_DL_TEXT && (NULL == e.data || NULL == e.tiles || ((uintptr_t)e.tiles & 3) || _screenPixels != 256)))
+    {
+      ESP_LOGE(TAG, "Display list entry %d invalid", n);
+      return;
+    }
+    lines += e.lines;
+  }
+  if (lines > _window_lines)
+  {
+    ESP_LOGE(TAG, "Display list covers %d lines, more than %d", lines, _window_lines);
+    return;
+  }
+
+  if (0 == count)
+  {
+    _displayListNext = NULL;
+    _displayListReady = true;
+    return;
+  }
+
+  if (NULL == _displayListTables)
+  {
+    _displayListTables = new dl_table[2];
+    if (NULL == _displayListTables)
+    {
+      ESP_LOGE(TAG, "Display list table allocation fail");
+      ESP_ERROR_CHECK(ESP_FAIL);
+    }
+  }
+
+  // Fill whichever table is not on screen
+  _displayListReady = false;
+  dl_table* table = (_displayList == _displayListTables) ? _displayListTables + 1 : _displayListTables;
+  int y = 0;
+  for (int n = 0; n < count; n++)
+  {
+    const ESP_8_BIT_display_list_entry& e = list[n];
+    table->entry[n] = e;
+    for (int row = 0; row < e.lines; row++, y++)
+    {
+      dl_line& l = table->line[y];
+      l.entry = n;
+      l.row = row;
+      l.mode = e.mode;
+      l.color = e.color;
+      if (e.mode == ESP_8_BIT_DL_GRADIENT && e.lines > 1)
+      {
+        l.color = blend_rgb332(e.color, e.color2, row*255/(e.lines - 1));
+      }
+    }
+  }
+  for (; y < MAX_WINDOW_LINES; y++)
+  {
+    table->line[y].mode = ESP_8_BIT_DL_SOLID;
+    table->line[y].color = 0;
+  }
+
+  _displayListNext = table;
+  _displayListReady = true;
+}
+
+/*
+ * @brief Place a sprite on screen, drawn over the picture as it is sent out
+ */
+void ESP_8_BIT_composite::setSprite(uint8_t index, const uint8_t* image, int16_t x, int16_t y, uint8_t size, uint8_t transparent)
+{
+  instance_check();
+
+  if (index >= ESP_8_BIT_MAX_SPRITES)
+  {
+    ESP_LOGE(TAG, "Sprite index %d out of range", index);
+    return;
+  }
+  if (size != 8 && size != 16)
+  {
+    ESP_LOGE(TAG, "Sprite size must be 8 or 16");
+    return;
+  }
+  if (_mono)
+  {
+    ESP_LOGE(TAG, "Sprites are not available in monochrome mode");
+    return;
+  }
+
+  if (NULL == _sprites)
+  {
+    _sprites = new sprite_entry[ESP_8_BIT_MAX_SPRITES];
+    _spritesNext = new sprite_entry[ESP_8_BIT_MAX_SPRITES];
+    _spriteLineList = new uint8_t[MAX_WINDOW_LINES*ESP_8_BIT_SPRITES_PER_LINE];
+    uint8_t* lineCount = new uint8_t[MAX_WINDOW_LINES];
+    if (NULL == _sprites || NULL == _spritesNext || NULL == _spriteLineList || NULL == lineCount)
+    {
+      ESP_LOGE(TAG, "Sprite table allocation fail");
+      ESP_ERROR_CHECK(ESP_FAIL);
+    }
+    for (int i = 0; i < ESP_8_BIT_MAX_SPRITES; i++)
+    {
+      _sprites[i].image = NULL;
+      _spritesNext[i].image = NULL;
+    }
+    memset(lineCount, 0, MAX_WINDOW_LINES);
+    // Publish last, video_isr() checks this to see if sprites are in use.
+    _spriteLineCount = lineCount;
+  }
+
+  sprite_entry& s = _spritesNext[index];
+  s.image = image;
+  s.x = x;
+  s.y = y;
+  s.size = size;
+  s.transparent = transparent;
+}
+
+/*
+ * @brief Remove a sprite from screen
+ */
+void ESP_8_BIT_composite::hideSprite(uint8_t index)
+{
+  instance_check();
+
+  if (_spritesNext && index < ESP_8_BIT_MAX_SPRITES)
+  {
+    _spritesNext[index].image = NULL;
+  }
+}
+
+/*
+ * @brief Apply sprite changes at the next vertical blank
+ */
+void ESP_8_BIT_composite::commitSprites()
+{
+  instance_check();
+
+  if (_spritesNext)
+  {
+    _spritesReady = true;
+  }
+}
+
+/*
+ * @brief Most CPU clock cycles spent drawing sprites on a single line
+ * during the last complete frame
+ */
+uint32_t ESP_8_BIT_composite::getSpriteCycles()
+{
+  return _spriteCyclesLastFrame;
+}
+
+/*
+ * @brief Number of sprite lines dropped for exceeding the per-line limit
+ */
+uint32_t ESP_8_BIT_composite::getSpriteDropCount()
+{
+  return _spriteDropCount;
+}
+
+/*
+ * @brief Register, replace or remove the callback for a screen line
+ */
+void ESP_8_BIT_composite::setRasterCallback(int line, ESP_8_BIT_raster_callback callback, void* arg)
+{
+  instance_check();
+
+  // Interlaced, the first field has the extra half line's worth of lines
+  int lineCount = _pal_ ? PAL_LINES : NTSC_LINES;
+  if (_interlace)
+  {
+    lineCount++;
+  }
+  if (line < 0 || line >= lineCount)
+  {
+    ESP_LOGE(TAG, "Raster callback line %d out of range", line);
+    return;
+  }
+
+  // Remove existing entry for this line, if any
+  int n = 0;
+  while (n < _rasterStagedCount && _rasterStaged[n].line < line)
+  {
+    n++;
+  }
+  if (n < _rasterStagedCount && _rasterStaged[n].line == line)
+  {
+    for (int m = n; m < _rasterStagedCount - 1; m++)
+    {
+      _rasterStaged[m] = _rasterStaged[m + 1];
+    }
+    _rasterStagedCount--;
+  }
+
+  if (callback)
+  {
+    if (_rasterStagedCount == ESP_8_BIT_MAX_RASTER_CALLBACKS)
+    {
+      ESP_LOGE(TAG, "No room for raster callback at line %d", line);
+      return;
+    }
+    for (int m = _rasterStagedCount; m > n; m--)
+    {
+      _rasterStaged[m] = _rasterStaged[m - 1];
+    }
+    _rasterStaged[n].line = line;
+    _rasterStaged[n].callback = callback;
+    _rasterStaged[n].arg = arg;
+    _rasterStagedCount++;
+  }
+
+  _rasterReady = true;
+}
+
+/*
+ * @brief Most CPU clock cycles video_isr() spent on a line with a raster
+ * callback, callback included, during the last complete frame
+ */
+uint32_t ESP_8_BIT_composite::getRasterCycles()
+{
+  return _rasterCyclesLastFrame;
+}
+
+/*
+ * @brief Number of lines where video_isr() plus raster callback ran longer
+ * than the line lasts
+ */
+uint32_t ESP_8_BIT_composite::getRasterOverrunCount()
+{
+  return _rasterOverrunCount;
+}
+
+// Whether the frame buffer has the 256x240 progressive layout bands are
+// cut from, _bandLines is in lines of that layout
+static bool bands_supported()
+{
+    return _frameWidth == bytesPerLine && _frameBytes == bytesPerLine &&
+        _frameHeight == linesPerFrame && !_interlace;
+}
+
+/*
+ * @brief Split frame buffer into bands that can be presented independently
+ */
+void ESP_8_BIT_composite::setBandCount(int bands)
+{
+  instance_check();
+
+  // Bands are whole frame buffer chunks, so each chunk stays contiguous
+  // in both line arrays. See frameBufferAlloc().
+  if (bands < 1 || bands > ESP_8_BIT_MAX_BANDS || chunksPerFrame % bands)
+  {
+    ESP_LOGE(TAG, "Band count %d must divide %d", bands, chunksPerFrame);
+    return;
+  }
+  if (bands > 1 && !bands_supported())
+  {
+    ESP_LOGE(TAG, "Bands require full 256x240 progressive resolution");
+    return;
+  }
+  if (_bandPending)
+  {
+    ESP_LOGE(TAG, "Band count can not change while bands are pending");
+    return;
+  }
+
+  _bandCount = bands;
+  _bandLines = linesPerFrame / bands;
+}
+
+/*
+ * @brief Send one band of the back buffer to screen, without waiting for
+ * the rest of the frame
+ */
+void ESP_8_BIT_composite::presentBand(int band)
+{
+  instance_check();
+
+  if (NULL == _lines)
+  {
+    ESP_LOGE(TAG, "presentBand() requires a frame buffer");
+    return;
+  }
+  if (!bands_supported())
+  {
+    ESP_LOGE(TAG, "Bands require full 256x240 progressive resolution");
+    return;
+  }
+  if (band < 0 || band >= _bandCount)
+  {
+    ESP_LOGE(TAG, "Band %d out of range", band);
+    return;
+  }
+
+  // video_isr() notifies whenever it swapped bands or buffers
+  uint32_t bit = 1 << band;
+  _bandPresentStart[band] = cpu_ticks();
+  _bandPending |= bit;
+  while (_bandPending & bit)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+/*
+ * @brief Number of lines in each band
+ */
+int ESP_8_BIT_composite::getBandLines()
+{
+  return _bandLines;
+}
+
+/*
+ * @brief Swap front and back buffer at the next line instead of waiting
+ * for vertical blank
+ */
+void ESP_8_BIT_composite::presentImmediate()
+{
+  instance_check();
+
+  if (NULL == _lines)
+  {
+    ESP_LOGE(TAG, "presentImmediate() requires a frame buffer");
+    return;
+  }
+
+  _latency[ESP_8_BIT_PRESENT_IMMEDIATE].start = cpu_ticks();
+  _swapImmediate = true;
+  while (_swapImmediate)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+/*
+ * @brief Average time from present until the first presented line is
+ * generated for video output
+ */
+uint32_t ESP_8_BIT_composite::getPresentLatency(ESP_8_BIT_present_mode mode)
+{
+  const present_latency& l = _latency[mode];
+  return l.count ? l.sum_us / l.count : 0;
+}
+
+// Samples per pixel of the blit kernel for a frame buffer width, after
+// doubling. Zero if the width is not supported.
+static int width_samples_per_pixel(int width, int samplesPerCC)
+{
+  switch (width)
+  {
+    case 160:
+    case 192:
+      return samplesPerCC;
+    case 128:
+    case 256:
+      return samplesPerCC == 3 ? 2 : 3;
+    case 320:
+    case 384:
+      return samplesPerCC == 3 ? 0 : 2;
+  }
+  return 0;
+}
+
+// Frame buffer size and picture placement follow window, resolution and
+// interlace settings
+static void update_frame_size()
+{
+  // Full width picture centered on screen, starting at phase 0 of an even
+  // sample so blit kernels line up with color clocks and 32-bit words
+  int align = 2*_samples_per_cc;
+  _screenSamples = SCREEN_COLOR_CLOCKS*_samples_per_cc;
+  _pictureStart = (_screenSamples - _screenPixels*_samplesPerPixel)/2/align*align;
+  if (_screenPixels == 256)
+  {
+    // Window is in 256 pixel screen coordinates
+    _linePixels = _window_width;
+    _pictureStart += _window_x*_samplesPerPixel;
+    _frameWidth = _window_width >> _pixelShift;
+  }
+  else
+  {
+    // Full width window
+    _linePixels = _screenPixels;
+    _frameWidth = _screenPixels;
+  }
+  _pictureSamples = _linePixels*_samplesPerPixel;
+  _frameBytes = _mono ? _frameWidth*_monoBits/8 : _frameWidth;
+  _frameHeight = _window_lines >> _lineShift;
+  if (_interlace && NULL == _fieldCallback)
+  {
+    _frameHeight *= 2;
+  }
+}
+
+/*
+ * @brief Choose frame buffer resolution, doubled up to fill the screen
+ */
+void ESP_8_BIT_composite::setResolution(int width, int height)
+{
+  instance_check();
+
+  if (_started)
+  {
+    ESP_LOGE(TAG, "setResolution() must be called before begin().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_mono)
+  {
+    ESP_LOGE(TAG, "Monochrome resolution is set by setMonochrome().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  int samplesPerPixel = width_samples_per_pixel(width, _samples_per_cc);
+  if (0 == samplesPerPixel || (height != 240 && height != 120))
+  {
+    ESP_LOGE(TAG, "Unsupported resolution %dx%d", width, height);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_tileMap && (width != 256 || height != 240))
+  {
+    ESP_LOGE(TAG, "Tile mode is only available at 256x240.");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_interlace && height != 240)
+  {
+    ESP_LOGE(TAG, "Interlace needs full height resolution");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  if (width == 128 && (_window_width & 7))
+  {
+    ESP_LOGE(TAG, "Half width needs active window width multiple of 8");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (width != 128 && width != 256 && (_window_x != 0 || _window_width != bytesPerLine))
+  {
+    ESP_LOGE(TAG, "Width %d needs full width active window", width);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  _pixelShift = (width == 128);
+  _lineShift = (height == 120);
+  _screenPixels = (width == 128) ? 256 : width;
+  _samplesPerPixel = samplesPerPixel;
+  update_frame_size();
+}
+
+/*
+ * @brief Choose 3 or 4 DAC samples per color clock
+ */
+void ESP_8_BIT_composite::setSamplesPerColorClock(int samples)
+{
+  instance_check();
+
+  if (_started)
+  {
+    ESP_LOGE(TAG, "setSamplesPerColorClock() must be called before begin().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if ((samples != 3 && samples != 4) || (samples == 3 && (_pal_ || _mono)))
+  {
+    ESP_LOGE(TAG, "%d samples per color clock not supported, 3 is NTSC color only", samples);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  int width = _pixelShift ? 128 : _screenPixels;
+  int samplesPerPixel = width_samples_per_pixel(width, samples);
+  if (0 == samplesPerPixel)
+  {
+    ESP_LOGE(TAG, "Width %d not available at %d samples per color clock", width, samples);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (samples == 3 && (_window_x % 12))
+  {
+    ESP_LOGE(TAG, "Active window x must be a multiple of 12 at 3 samples per color clock");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  _samples_per_cc = samples;
+  _samplesPerPixel = samplesPerPixel;
+  update_frame_size();
+
+  // Stock palette differs, rebuild any transform from it
+  applyPaletteTransform();
+}
+
+/*
+ * @brief Switch to a luminance only frame buffer of 1 or 2 bits per pixel
+ */
+void ESP_8_BIT_composite::setMonochrome(int width, int bitsPerPixel)
+{
+  instance_check();
+
+  if (_started)
+  {
+    ESP_LOGE(TAG, "setMonochrome() must be called before begin().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if ((bitsPerPixel != 1 && bitsPerPixel != 2) ||
+      (width != 320 && width != 384 && width != 512 && width != 640 && width != 768))
+  {
+    ESP_LOGE(TAG, "Unsupported monochrome resolution %d wide at %d bits per pixel", width, bitsPerPixel);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_samples_per_cc != 4 || _tileMap || _displayListNext || _bandCount > 1 ||
+      _window_x != 0 || _window_width != bytesPerLine)
+  {
+    ESP_LOGE(TAG, "Monochrome needs 4 samples per color clock, full width window, no tiles, display list or bands");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  int samplesPerPixel = width > MAX_LINE_PIXELS ? 1 : 2;
+  _mono = true;
+  _monoBits = bitsPerPixel;
+  _monoWords = (4/bitsPerPixel)*samplesPerPixel/2;
+  _pixelShift = 0;
+  _screenPixels = width;
+  _samplesPerPixel = samplesPerPixel;
+  update_frame_size();
+}
+
+/*
+ * @brief Frame buffer bits per pixel
+ */
+int ESP_8_BIT_composite::getBitsPerPixel()
+{
+  return _mono ? _monoBits : 8;
+}
+
+/*
+ * @brief CPU clock cycles the blit kernel for a frame buffer width takes
+ * to encode one line
+ */
+uint32_t ESP_8_BIT_composite::getBlitCycles(int width)
+{
+  instance_check();
+
+  int samplesPerPixel = width_samples_per_pixel(width, _samples_per_cc);
+  if (_started || 0 == samplesPerPixel)
+  {
+    ESP_LOGE(TAG, "getBlitCycles() needs a supported width, before begin()");
+    return 0;
+  }
+
+  uint8_t* src = new uint8_t[MAX_LINE_PIXELS];
+  uint16_t* dst = new uint16_t[PAL_COLOR_CLOCKS_PER_SCANLINE*4];
+  if (NULL == src || NULL == dst)
+  {
+    ESP_LOGE(TAG, "Blit benchmark line allocation fail");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  for (int i = 0; i < MAX_LINE_PIXELS; i++)
+  {
+    src[i] = i*37;
+  }
+
+  // Borrow line geometry of the given width, video is not running yet
+  int linePixels = _linePixels;
+  int lineSamplesPerPixel = _samplesPerPixel;
+  _linePixels = (width == 128) ? 256 : width;
+  _samplesPerPixel = samplesPerPixel;
+
+  // Best of a few runs, the first ones warm up cache
+  uint32_t best = UINT32_MAX;
+  for (int n = 0; n < 8; n++)
+  {
+    uint32_t t = cpu_ticks();
+    if (width == 128 && _samples_per_cc == 3)
+    {
+      blit(double_pixels(src), dst, getDefaultPalette());
+    }
+    else if (width == 128)
+    {
+      blit_double(src, dst, getDefaultPalette());
+    }
+    else
+    {
+      blit(src, dst, getDefaultPalette());
+    }
+    t = cpu_ticks() - t;
+    if (t < best)
+    {
+      best = t;
+    }
+  }
+
+  _linePixels = linePixels;
+  _samplesPerPixel = lineSamplesPerPixel;
+  delete[] src;
+  delete[] dst;
+  return best;
+}
+
+/*
+ * @brief Frame buffer width in pixels
+ */
+int ESP_8_BIT_composite::getWidth()
+{
+  return _frameWidth;
+}
+
+/*
+ * @brief Frame buffer height in pixels
+ */
+int ESP_8_BIT_composite::getHeight()
+{
+  return _frameHeight;
+}
+
+/*
+ * @brief Place the picture within the screen, surrounded by border
+ */
+void ESP_8_BIT_composite::setActiveWindow(int x, int y, int width, int height)
+{
+  instance_check();
+
+  if (_started)
+  {
+    ESP_LOGE(TAG, "setActiveWindow() must be called before begin().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  int screenLines = _pal_ ? (_interlace ? PAL_FIELD_LINES : MAX_WINDOW_LINES) : linesPerFrame;
+  if (x < 0 || (x & 3) || width < 4 || (width & 3) || x + width > bytesPerLine ||
+      y < 0 || height < 2 || y + height > screenLines)
+  {
+    ESP_LOGE(TAG, "Active window %dx%d at %d,%d does not fit", width, height, x, y);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if ((_pixelShift && (width & 7)) || (_lineShift && (height & 1)))
+  {
+    ESP_LOGE(TAG, "Active window %dx%d can not be halved per setResolution()", width, height);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_tileMap && (width != bytesPerLine || height != linesPerFrame))
+  {
+    ESP_LOGE(TAG, "Tile mode is only available at 256x240.");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_screenPixels != 256 && (x != 0 || width != bytesPerLine))
+  {
+    ESP_LOGE(TAG, "Width %d needs full width active window", _screenPixels);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (_samples_per_cc == 3 && (x % 12))
+  {
+    ESP_LOGE(TAG, "Active window x must be a multiple of 12 at 3 samples per color clock");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  _window_x = x;
+  _window_y = y;
+  _window_width = width;
+  _window_lines = height;
+  update_frame_size();
+}
+
+/*
+ * @brief Switch between progressive and interlaced video
+ */
+void ESP_8_BIT_composite::setInterlace(bool interlace, ESP_8_BIT_field_callback callback, void* arg)
+{
+  instance_check();
+
+  if (_started)
+  {
+    ESP_LOGE(TAG, "setInterlace() must be called before begin().");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (interlace && (_lineShift || _tileMap || _bandCount > 1))
+  {
+    ESP_LOGE(TAG, "Interlace needs full height, no tile mode and no bands");
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+  if (interlace && _pal_ && _window_y + _window_lines > PAL_FIELD_LINES)
+  {
+    ESP_LOGE(TAG, "Interlaced PAL fields are %d lines, active window does not fit", PAL_FIELD_LINES);
+    ESP_ERROR_CHECK(ESP_FAIL);
+  }
+
+  _interlace = interlace;
+  _fieldCallback = interlace ? callback : NULL;
+  _fieldCallbackArg = arg;
+  update_frame_size();
+}
+
+/*
+ * @brief Color of screen area outside the active window
+ */
+void ESP_8_BIT_composite::setBorderColor(uint8_t color)
+{
+  instance_check();
+
+  _border_color = color;
+}
@@ -62,6 +62,89 @@ SOFTWARE.
 #include "hal/adc_ll.h"
 #include "hal/dac_ll.h"
 #include "hal/clk_gate_ll.h"
+/*
+ * @brief Tile mode geometry: a 32x30 map of 8x8 pixel tiles covers the
+ * 256x240 screen. Each tile is 64 bytes of RGB332 pixels, row by row.
+ */
+#define ESP_8_BIT_TILE_SIZE 8
+#define ESP_8_BIT_TILE_BYTES (ESP_8_BIT_TILE_SIZE*ESP_8_BIT_TILE_SIZE)
+#define ESP_8_BIT_TILE_MAP_WIDTH 32
+#define ESP_8_BIT_TILE_MAP_HEIGHT 30
+
+/*
+ * @brief Sprite overlay limits: number of sprites in the sprite table, and
+ * how many of them may share a single line.
+ */
+#define ESP_8_BIT_MAX_SPRITES 32
+#define ESP_8_BIT_SPRITES_PER_LINE 8
+
+/*
+ * @brief Raster callback, run by the video interrupt as it finishes
+ * generating a screen line. Must be IRAM_ATTR and quick, as it shares the
+ * line's time budget with video generation.
+ * @param line Screen line the callback was registered for
+ * @param arg Value given to setRasterCallback()
+ */
+typedef void (*ESP_8_BIT_raster_callback)(int line, void* arg);
+#define ESP_8_BIT_MAX_RASTER_CALLBACKS 8
+
+/*
+ * @brief Ways a new frame reaches the screen, for getPresentLatency()
+ */
+enum ESP_8_BIT_present_mode {
+  ESP_8_BIT_PRESENT_FRAME,      // waitForFrame(), swap at vertical blank
+  ESP_8_BIT_PRESENT_BAND,       // presentBand()
+  ESP_8_BIT_PRESENT_IMMEDIATE   // presentImmediate(), may tear
+};
+#define ESP_8_BIT_MAX_BANDS 15
+
+/*
+ * @brief Largest frame buffer: lines of a full PAL window, pixels of the
+ * widest setResolution() line
+ */
+#define ESP_8_BIT_MAX_WINDOW_LINES 288
+#define ESP_8_BIT_MAX_LINE_PIXELS 384
+
+/*
+ * @brief Display list: a table of entries, each covering a band of screen
+ * lines from top to bottom, telling the video generator what to show there.
+ * Solid, gradient and repeated lines cost no frame buffer memory and are
+ * encoded without per-pixel palette lookups.
+ */
+enum ESP_8_BIT_display_list_mode {
+  ESP_8_BIT_DL_BITMAP,    // 256 pixel RGB332 lines
+  ESP_8_BIT_DL_SOLID,     // every line one color
+  ESP_8_BIT_DL_GRADIENT,  // vertical blend from color to color2
+  ESP_8_BIT_DL_TEXT,      // rows of 8x8 tiles
+  ESP_8_BIT_DL_REPEAT     // repeat the line above
+};
+
+struct ESP_8_BIT_display_list_entry {
+  uint8_t mode;           // ESP_8_BIT_display_list_mode
+  uint8_t lines;          // screen lines covered by this entry
+  uint8_t color;          // SOLID color, GRADIENT top color
+  uint8_t color2;         // GRADIENT bottom color
+  uint16_t source;        // BITMAP: first frame buffer line shown
+  const uint8_t* data;    // BITMAP: if set, pixels are read from here instead
+                          // of frame buffer, 256 bytes per line (getWidth()
+                          // if not 128 or 256), 32-bit aligned.
+                          // TEXT: 32 tile indices per 8 lines, as tile map rows.
+  const uint8_t* tiles;   // TEXT: tile set, as for setTileMode()
+};
+#define ESP_8_BIT_MAX_DISPLAY_LIST 32
+
+/*
+ * @brief Field callback for interlaced mode with one field in RAM, run by
+ * the video interrupt to draw an odd frame line right before it is sent
+ * out. Must be IRAM_ATTR and quick, as it shares the line's time budget
+ * with video generation.
+ * @param line Odd frame line to draw, 1 to 2*getHeight()-1
+ * @param pixels getWidth() RGB332 pixels to fill in, packed as in the
+ * frame buffer in monochrome mode
+ * @param arg Value given to setInterlace()
+ */
+typedef void (*ESP_8_BIT_field_callback)(int line, uint8_t* pixels, void* arg);
+
 class ESP_8_BIT_composite
 {
   public:
@@ -84,10 +167,165 @@ class ESP_8_BIT_composite
     void begin();
 
     /*
-     * @brief Wait for current frame to finish rendering
+     * @brief Wait for current frame to finish rendering. Returns once the
+     * back buffer has been swapped to screen at vertical blank, so
+     * getFrameBufferLines() then has the new back buffer to draw into.
      */
     void waitForFrame();
 
+    /*
+     * @brief Split the frame buffer into horizontal bands for presentBand().
+     * @param bands 1, 3, 5 or 15 bands of 240, 80, 48 or 16 lines.
+     */
+    void setBandCount(int bands);
+
+    /*
+     * @brief Number of lines in each band set by setBandCount()
+     */
+    int getBandLines();
+
+    /*
+     * @brief Send one finished band of the back buffer to screen without
+     * waiting for the whole frame, cutting input-to-display latency. The
+     * band is swapped while video generation is outside of it, so it never
+     * tears, and this waits until that happened. The band's lines in the
+     * back buffer then hold older content, as after waitForFrame().
+     * @note Bands refer to frame buffer lines, any setScrollY() or
+     * setLineSource() remapping is not taken into account.
+     */
+    void presentBand(int band);
+
+    /*
+     * @brief Swap front and back buffer as soon as the next line starts,
+     * without waiting for vertical blank. Lowest latency, but the picture
+     * tears where the swap happened.
+     */
+    void presentImmediate();
+
+    /*
+     * @brief Average time in microseconds from presenting a frame or band
+     * until its first line is generated for video output
+     */
+    uint32_t getPresentLatency(ESP_8_BIT_present_mode mode);
+
+    /*
+     * @brief Use a smaller frame buffer that is doubled up to fill the
+     * screen as it is sent out, for 2-4x less memory and drawing, or a
+     * different number of pixels across the screen.
+     * @param width 256, or 128 to show each pixel twice as wide. 192 or
+     * 384 for one or two pixels per color clock across the same width,
+     * 160 or 320 for the same at 5/6 of the width, centered.
+     * @param height 240, or 120 to show each line twice
+     * @note Must be called before begin(). Not available in tile mode.
+     * Scroll, sprite and display list positions stay in 256x240 screen
+     * coordinates, except display list frame buffer source lines.
+     * @note With setActiveWindow() the frame buffer is halved relative to
+     * the window instead, 128 meaning half the window width.
+     * @note At widths other than 128 and 256 the active window must span
+     * the whole width, display list text is not available, and scroll,
+     * sprite and display list bitmap positions are in frame buffer pixels.
+     */
+    void setResolution(int width, int height);
+
+    /*
+     * @brief Measure the blit kernel of a frame buffer width, to see which
+     * widths fit the line time budget. Each line lasts about 15250 (NTSC)
+     * or 15360 (PAL) cycles at 240MHz, shared with sync, sprites, raster
+     * callbacks and everything else the CPU core is doing.
+     * @param width Frame buffer width as for setResolution()
+     * @return CPU clock cycles to encode one full width line
+     * @note Must be called before begin().
+     */
+    uint32_t getBlitCycles(int width);
+
+    /*
+     * @brief Generate NTSC with 3 instead of 4 DAC samples per color clock,
+     * cutting DMA bandwidth and per-line encoding work by a quarter.
+     * @param samples 3 or 4 (default). 3 is only available for NTSC.
+     * @note Must be called before begin(). At 3 samples per color clock
+     * widths 320 and 384 are not available and active window x must be a
+     * multiple of 12. Palettes are in a different layout, custom palettes
+     * need ESP_8_BIT_ntscPalette<Colors, 3>.
+     */
+    void setSamplesPerColorClock(int samples);
+
+    /*
+     * @brief Send luminance only video, without color burst, from a frame
+     * buffer of 1 or 2 bits per pixel. Not bound to color clocks, pixels
+     * are a single DAC sample (widths 512, 640, 768) or two (320, 384)
+     * across the full screen width, and encoding takes no palette lookups.
+     * Frame buffer lines pack 8 or 4 pixels per byte, leftmost pixel in
+     * the most significant bits.
+     * @param width 320, 384, 512, 640 or 768 pixels
+     * @param bitsPerPixel 1 for black and white, 2 for 4 gray levels
+     * @note Must be called before begin(), instead of setResolution().
+     * Levels are the luminance of palette colors 0x00 and 0xFF at 1 bit,
+     * 0x00, 0x49, 0xB6 and 0xFF at 2 bits, so palette transforms such as
+     * setInvert() and setBrightness() still apply, and border color is
+     * shown as its luminance. Needs a full width window, 4 samples per
+     * color clock, and has no tile mode, display list, bands, horizontal
+     * scroll, sprites or line palettes.
+     */
+    void setMonochrome(int width, int bitsPerPixel = 1);
+
+    /*
+     * @brief Frame buffer bits per pixel: 8, or 1 or 2 per setMonochrome()
+     */
+    int getBitsPerPixel();
+
+    /*
+     * @brief Show the picture in a window of the screen, for example only
+     * the area safe from overscan, surrounded by a solid border. Frame
+     * buffer covers just the window, saving memory, and border is drawn
+     * without per-pixel work, saving video generation time.
+     * @param x Left edge, multiple of 4, screen is 256 pixels wide
+     * @param y Top line. Screen is 240 lines, on PAL it grows up to 288
+     * if the window extends past line 240.
+     * @param width Multiple of 4 (of 8 at half width per setResolution())
+     * @param height Lines in window
+     * @note Must be called before begin(). Frame buffer, tile, display
+     * list, scroll, sprite and line palette coordinates are relative to
+     * the window. Tile mode and bands require the full 256x240 window.
+     */
+    void setActiveWindow(int x, int y, int width, int height);
+
+    /*
+     * @brief Color of screen area outside active window, default black
+     */
+    void setBorderColor(uint8_t color);
+
+    /*
+     * @brief Send interlaced 480i (NTSC) or 576i (PAL) video: two fields
+     * per frame, the second half a line lower, for twice the lines at half
+     * the frame rate. Even frame buffer lines go to the first field and odd
+     * lines to the second. The 480 line frame buffer is too big to double
+     * buffer, so drawing shows up on screen right away.
+     * @param interlace true for interlaced video, false for progressive
+     * @param callback If set, only the even lines are kept in a double
+     * buffered frame buffer and odd lines are drawn by the callback as
+     * they are sent out, for text and menu screens that can render lines
+     * on the fly.
+     * @param arg Passed to callback
+     * @note Must be called before begin(). Needs full height per
+     * setResolution(), not available in tile mode or with bands. Window,
+     * display list, scroll, sprite, line palette and raster coordinates
+     * count lines of one field, up to 286 on PAL. Display list frame buffer
+     * source lines do too, showing line pairs.
+     */
+    void setInterlace(bool interlace, ESP_8_BIT_field_callback callback = NULL, void* arg = NULL);
+
+    /*
+     * @brief Frame buffer width in pixels, per setResolution() and
+     * setActiveWindow()
+     */
+    int getWidth();
+
+    /*
+     * @brief Frame buffer height in pixels, per setResolution(),
+     * setActiveWindow() and setInterlace()
+     */
+    int getHeight();
+
     /*
      * @brief Retrieve pointer to frame buffer lines array
      */
@@ -102,6 +340,192 @@ class ESP_8_BIT_composite
      * @brief Number of buffer swaps performed
      */
     uint32_t getBufferSwapCount();
+
+    /*
+     * @brief Default palette phase table for the current video standard:
+     * 256 entries for NTSC, 512 entries (even lines then odd lines) for PAL.
+     * Useful as starting point for building custom line palettes.
+     */
+    const uint32_t* getDefaultPalette();
+
+    /*
+     * @brief Use a different palette for a horizontal band of lines, for
+     * example a sky gradient or a status bar with its own set of colors.
+     * @param firstLine First frame buffer line (0-239) of the band
+     * @param lineCount Number of lines in the band
+     * @param palette Phase table laid out like getDefaultPalette(), or NULL
+     * to return these lines to the default palette. Must stay valid and
+     * live in internal RAM (DRAM_ATTR) while in use.
+     * @note Changes are staged, call commitLinePalettes() to apply them at
+     * the next vertical blank.
+     */
+    void setLinePalette(int firstLine, int lineCount, const uint32_t* palette);
+
+    /*
+     * @brief Apply all staged setLinePalette() changes at the next vertical
+     * blank, so the whole table switches between frames.
+     */
+    void commitLinePalettes();
+
+    /*
+     * @brief Scale brightness of the whole picture by rewriting the palette
+     * instead of the frame buffer. Takes effect at the next vertical blank.
+     * @param brightness 0 for black, 255 (default) for unchanged. Fades are
+     * made by stepping through this value once per frame.
+     */
+    void setBrightness(uint8_t brightness);
+
+    /*
+     * @brief Swap every color on screen for its inverse (including hue) by
+     * rewriting the palette. Takes effect at the next vertical blank.
+     */
+    void setInvert(bool invert);
+
+    /*
+     * @brief Remove color from the picture, leaving luminance only. Takes
+     * effect at the next vertical blank.
+     */
+    void setGrayscale(bool grayscale);
+
+    /*
+     * @brief Blend color of the whole picture toward the hue of a RGB332
+     * color while keeping brightness of each pixel. Takes effect at the next
+     * vertical blank.
+     * @param color RGB332 color to tint toward
+     * @param amount 0 (default) for no tint, 255 for fully tinted monochrome
+     */
+    void setTint(uint8_t color, uint8_t amount);
+
+    /*
+     * @brief Draw the screen from a tile map instead of a frame buffer. No
+     * frame buffer is allocated and getFrameBufferLines() returns NULL, the
+     * screen is changed by writing tile indices into the map. Must be called
+     * before begin().
+     * @param tileSet Up to 256 tiles of ESP_8_BIT_TILE_BYTES each, 32-bit
+     * aligned and in internal RAM (DRAM_ATTR) as it is read by the ISR.
+     * @param tileMap ESP_8_BIT_TILE_MAP_WIDTH x ESP_8_BIT_TILE_MAP_HEIGHT
+     * tile indices, row by row. Changes show up on the next line drawn.
+     */
+    void setTileMode(const uint8_t* tileSet, uint8_t* tileMap);
+
+    /*
+     * @brief Scroll tile map by given pixel offset. The map wraps around at
+     * its edges. Takes effect at the next vertical blank.
+     */
+    void setTileScroll(int x, int y);
+
+    /*
+     * @brief Scroll the whole picture vertically with wrap-around. Screen
+     * line y shows frame buffer line (y + originY) modulo 240, so scrolling
+     * rotates line pointers rather than moving pixels.
+     * @note Scroll changes are staged, call commitScroll() to apply them
+     * together at the next vertical blank.
+     */
+    void setScrollY(int originY);
+
+    /*
+     * @brief Show frame buffer lines sourceLine onwards on screen lines
+     * firstLine to firstLine+lineCount-1, overriding setScrollY() there.
+     * Useful for split screens such as a fixed status bar.
+     * @param sourceLine First frame buffer line, or -1 to have the band
+     * follow setScrollY() again
+     */
+    void setLineSource(int firstLine, int lineCount, int sourceLine);
+
+    /*
+     * @brief Scroll a band of screen lines left by offsetX pixels, wrapping
+     * around at 256. Different bands can scroll independently, for
+     * tickers and parallax layers.
+     */
+    void setLineScrollX(int firstLine, int lineCount, int offsetX);
+
+    /*
+     * @brief Apply all staged scroll changes at the next vertical blank
+     */
+    void commitScroll();
+
+    /*
+     * @brief Describe the screen with a display list instead of showing the
+     * frame buffer as a whole, for mixed screens such as a text status bar
+     * over a bitmap play area framed by solid borders.
+     * @param list Entries from top of screen down, copied so the array need
+     * not be kept. Lines past the last entry are black. NULL to go back to
+     * showing the frame buffer.
+     * @param count Number of entries, up to ESP_8_BIT_MAX_DISPLAY_LIST
+     * @note Takes effect at the next vertical blank. When called before
+     * begin() with a list where no BITMAP entry uses the frame buffer (all
+     * have data set), no frame buffer is allocated at all. Such a display
+     * list can then be replaced but not removed.
+     * @note setScrollY() and setLineSource() do not apply to display list
+     * screens, setLineScrollX(), sprites and line palettes do.
+     */
+    void setDisplayList(const ESP_8_BIT_display_list_entry* list, int count);
+
+    /*
+     * @brief Place a sprite that is drawn over the picture as each line is
+     * sent to screen. Sprites never touch the frame buffer, so moving one
+     * requires no redraw of what was behind it. Lower index is drawn on top.
+     * @param index Sprite slot, 0 to ESP_8_BIT_MAX_SPRITES-1
+     * @param image size*size RGB332 pixels, in internal RAM (DRAM_ATTR)
+     * @param x Left edge on screen, may be partially off screen
+     * @param y Top edge on screen, may be partially off screen
+     * @param size Width and height, 8 or 16
+     * @param transparent Color of pixels in image that are not drawn
+     * @note Changes are staged, call commitSprites() to apply them at the
+     * next vertical blank.
+     */
+    void setSprite(uint8_t index, const uint8_t* image, int16_t x, int16_t y, uint8_t size, uint8_t transparent);
+
+    /*
+     * @brief Remove a sprite from screen. Staged until commitSprites().
+     */
+    void hideSprite(uint8_t index);
+
+    /*
+     * @brief Apply all staged sprite changes at the next vertical blank
+     */
+    void commitSprites();
+
+    /*
+     * @brief Most CPU clock cycles spent compositing sprites on a single line
+     * during the last frame. A line lasts roughly 15000 cycles at 240MHz.
+     */
+    uint32_t getSpriteCycles();
+
+    /*
+     * @brief Number of sprite lines not drawn because more than
+     * ESP_8_BIT_SPRITES_PER_LINE sprites shared that line
+     */
+    uint32_t getSpriteDropCount();
+
+    /*
+     * @brief Call a function each frame when video generation reaches the
+     * given screen line, in the spirit of classic raster interrupts. For
+     * example to notify a task it may start drawing the upper half of the
+     * next frame once the picture has moved past it.
+     * @param line Screen line, 0-239 are the active picture, 240 onwards
+     * are the blank and sync lines that follow (to 261 NTSC, 311 PAL)
+     * @param callback Function to call, or NULL to remove the line's callback
+     * @param arg Passed to callback
+     * @note Takes effect at the next vertical blank. Up to
+     * ESP_8_BIT_MAX_RASTER_CALLBACKS lines may have a callback.
+     * @note Interlaced, lines count from the start of each field and the
+     * callback runs once per field. The first field is a line longer (to
+     * 262 NTSC, 312 PAL), that last line only runs in the first field.
+     */
+    void setRasterCallback(int line, ESP_8_BIT_raster_callback callback, void* arg = NULL);
+
+    /*
+     * @brief Most CPU clock cycles spent generating a line with a raster
+     * callback, callback included, during the last frame
+     */
+    uint32_t getRasterCycles();
+
+    /*
+     * @brief Number of lines where video generation plus raster callback
+     * took longer than the line lasts, starving video output
+     */
+    uint32_t getRasterOverrunCount();
   private:
     /*
      * @brief Check to ensure this instance is the first and only allowed instance
@@ -122,6 +546,18 @@ class ESP_8_BIT_composite
      * @brief Free memory allocated by frameBufferAlloc();
      */
     void frameBufferFree(uint8_t** frameBuffer);
+
+    /*
+     * @brief Rebuild palette per brightness/invert/grayscale/tint settings
+     * and stage it to be swapped in at next vertical blank.
+     * @note Lines using a palette from setLinePalette() are not transformed.
+     */
+    void applyPaletteTransform();
+
+    /*
+     * @brief Allocate scroll register tables on first use
+     */
+    void scrollAlloc();
 };
 
 #endif // ESP_8_BIT_COMPOSITE_H
@@ -0,0 +1,284 @@
+/*
+
+ESP_8_BIT color composite video palette phase table generator.
+
+A palette phase table entry holds the DAC levels of the four samples that
+make up one color clock of a given color: luminance plus chrominance at the
+phase relative to color burst. The functions here compute these entries at
+compile time, so a custom palette is built by the compiler and costs nothing
+at runtime. Example:
+
+  struct SkyColors
+  {
+    // Return 0xRRGGBB for each of the 256 palette indices
+    static constexpr uint32_t rgb(int index) { return index; }
+  };
+
+  static const DRAM_ATTR ESP_8_BIT_phase_table<256> skyPalette =
+    ESP_8_BIT_ntscPalette<SkyColors>();
+
+  videoOut.setLinePalette(0, 80, skyPalette.entry);
+
+PAL tables have 512 entries, use ESP_8_BIT_palPalette<>() instead.
+Generated tables must be in RAM (DRAM_ATTR) as they are read by the video
+interrupt service routine.
+
+Only constexpr features of C++11 are used, to stay compatible with the
+Arduino ESP32 toolchain.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#ifndef ESP_8_BIT_PALETTE_H
+#define ESP_8_BIT_PALETTE_H
+
+#include <stdint.h>
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Compile-time math helpers
+
+/*
+ * @brief Sine by Taylor series after reducing x to [-pi, pi]
+ */
+constexpr double ESP_8_BIT_sin_series(double x, double term, int n)
+{
+  return (term < 1e-12 && term > -1e-12) ? term :
+    term + ESP_8_BIT_sin_series(x, -term*x*x/((2*n)*(2*n+1)), n+1);
+}
+
+constexpr double ESP_8_BIT_reduce_angle(double x)
+{
+  return x > 3.14159265358979323846 ? ESP_8_BIT_reduce_angle(x - 2*3.14159265358979323846) :
+    (x < -3.14159265358979323846 ? ESP_8_BIT_reduce_angle(x + 2*3.14159265358979323846) : x);
+}
+
+constexpr double ESP_8_BIT_sin(double x)
+{
+  return ESP_8_BIT_sin_series(ESP_8_BIT_reduce_angle(x), ESP_8_BIT_reduce_angle(x), 1);
+}
+
+constexpr double ESP_8_BIT_cos(double x)
+{
+  return ESP_8_BIT_sin(x + 3.14159265358979323846/2);
+}
+
+constexpr double ESP_8_BIT_radians(double degrees)
+{
+  return degrees*3.14159265358979323846/180;
+}
+
+/*
+ * @brief List of integers 0..N-1 for expanding table initializers
+ */
+template<int... I> struct ESP_8_BIT_index_list {};
+template<int N, int... I> struct ESP_8_BIT_make_index_list : ESP_8_BIT_make_index_list<N-1, N-1, I...> {};
+template<int... I> struct ESP_8_BIT_make_index_list<0, I...> { typedef ESP_8_BIT_index_list<I...> type; };
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Phase table entry generators
+//
+//  Calibrated so generating the RGB332 palette reproduces the hand tuned
+//  tables inherited from ESP_8_BIT within one DAC step.
+
+/*
+ * @brief Black and white DAC levels, and chroma amplitude relative to
+ * black-to-white range.
+ */
+constexpr double ESP_8_BIT_NTSC_BLACK = 24.0;
+constexpr double ESP_8_BIT_NTSC_WHITE = 72.7;
+constexpr double ESP_8_BIT_NTSC_CHROMA = 0.409;
+constexpr double ESP_8_BIT_NTSC_PHASE = 239.0;
+constexpr double ESP_8_BIT_PAL_BLACK = 24.3;
+constexpr double ESP_8_BIT_PAL_WHITE = 73.2;
+constexpr double ESP_8_BIT_PAL_CHROMA = 0.66;
+constexpr double ESP_8_BIT_PAL_PHASE = 180.0;
+
+/*
+ * @brief Clamp and truncate to a DAC level
+ */
+constexpr uint32_t ESP_8_BIT_level(double v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : (uint32_t)v);
+}
+
+/*
+ * @brief Red, green and blue components (0.0-1.0) of a 0xRRGGBB color
+ */
+constexpr double ESP_8_BIT_red(uint32_t rgb) { return ((rgb >> 16) & 0xFF)/255.0; }
+constexpr double ESP_8_BIT_green(uint32_t rgb) { return ((rgb >> 8) & 0xFF)/255.0; }
+constexpr double ESP_8_BIT_blue(uint32_t rgb) { return (rgb & 0xFF)/255.0; }
+
+constexpr double ESP_8_BIT_luma(double r, double g, double b)
+{
+  return 0.299*r + 0.587*g + 0.114*b;
+}
+
+/*
+ * @brief NTSC DAC level of sample t (0-3) within a color clock of
+ * samplesPerCC samples, for the given color components.
+ */
+constexpr uint32_t ESP_8_BIT_ntscSample(double r, double g, double b, int t, int samplesPerCC)
+{
+  return ESP_8_BIT_level(ESP_8_BIT_NTSC_BLACK + (ESP_8_BIT_NTSC_WHITE - ESP_8_BIT_NTSC_BLACK)*(
+    ESP_8_BIT_luma(r, g, b) + ESP_8_BIT_NTSC_CHROMA*(
+      (0.596*r - 0.274*g - 0.322*b)*ESP_8_BIT_cos(ESP_8_BIT_radians(t*360.0/samplesPerCC + ESP_8_BIT_NTSC_PHASE)) +
+      (0.211*r - 0.523*g + 0.312*b)*ESP_8_BIT_sin(ESP_8_BIT_radians(t*360.0/samplesPerCC + ESP_8_BIT_NTSC_PHASE)))));
+}
+
+/*
+ * @brief PAL DAC level of sample t (0-3) within a color clock, for the given
+ * color components. V component is inverted on alternate lines.
+ */
+constexpr uint32_t ESP_8_BIT_palSample(double r, double g, double b, int t, bool altLine)
+{
+  return ESP_8_BIT_level(ESP_8_BIT_PAL_BLACK + (ESP_8_BIT_PAL_WHITE - ESP_8_BIT_PAL_BLACK)*(
+    ESP_8_BIT_luma(r, g, b) + ESP_8_BIT_PAL_CHROMA*(
+      0.492*(b - ESP_8_BIT_luma(r, g, b))*ESP_8_BIT_sin(ESP_8_BIT_radians(t*90.0 + ESP_8_BIT_PAL_PHASE)) +
+      (altLine ? -0.877 : 0.877)*(r - ESP_8_BIT_luma(r, g, b))*ESP_8_BIT_cos(ESP_8_BIT_radians(t*90.0 + ESP_8_BIT_PAL_PHASE)))));
+}
+
+/*
+ * @brief Pack four samples into a phase table entry. First sample sent to
+ * the DAC is in the most significant byte.
+ */
+constexpr uint32_t ESP_8_BIT_pack(uint32_t s0, uint32_t s1, uint32_t s2, uint32_t s3)
+{
+  return (s0 << 24) | (s1 << 16) | (s2 << 8) | s3;
+}
+
+/*
+ * @brief NTSC phase table entry for components in range 0.0-1.0
+ * @note With 3 samples per color clock the last byte repeats the first
+ * sample's phase.
+ */
+constexpr uint32_t ESP_8_BIT_ntscEntry(double r, double g, double b, int samplesPerCC = 4)
+{
+  return ESP_8_BIT_pack(
+    ESP_8_BIT_ntscSample(r, g, b, 0, samplesPerCC),
+    ESP_8_BIT_ntscSample(r, g, b, 1, samplesPerCC),
+    ESP_8_BIT_ntscSample(r, g, b, 2, samplesPerCC),
+    ESP_8_BIT_ntscSample(r, g, b, 3, samplesPerCC));
+}
+
+/*
+ * @brief PAL phase table entry for components in range 0.0-1.0
+ */
+constexpr uint32_t ESP_8_BIT_palEntry(double r, double g, double b, bool altLine)
+{
+  return ESP_8_BIT_pack(
+    ESP_8_BIT_palSample(r, g, b, 0, altLine),
+    ESP_8_BIT_palSample(r, g, b, 1, altLine),
+    ESP_8_BIT_palSample(r, g, b, 2, altLine),
+    ESP_8_BIT_palSample(r, g, b, 3, altLine));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Whole table generators
+
+/*
+ * @brief Phase table storage. Pass 'entry' wherever a palette is expected.
+ */
+template<int N> struct ESP_8_BIT_phase_table
+{
+  uint32_t entry[N];
+};
+
+/*
+ * @brief Color source for the stock RGB332 palette. Components are spread
+ * evenly over 0.0-1.0 (R and G in sevenths, B in thirds.)
+ */
+struct ESP_8_BIT_RGB332
+{
+  static constexpr double r(int index) { return (index >> 5)/7.0; }
+  static constexpr double g(int index) { return ((index >> 2) & 7)/7.0; }
+  static constexpr double b(int index) { return (index & 3)/3.0; }
+};
+
+/*
+ * @brief Adapts a color source returning 0xRRGGBB from rgb(index) into
+ * components as used by the table generators.
+ */
+template<typename Colors> struct ESP_8_BIT_RGB888
+{
+  static constexpr double r(int index) { return ESP_8_BIT_red(Colors::rgb(index)); }
+  static constexpr double g(int index) { return ESP_8_BIT_green(Colors::rgb(index)); }
+  static constexpr double b(int index) { return ESP_8_BIT_blue(Colors::rgb(index)); }
+};
+
+template<typename Components, int samplesPerCC, int... I>
+constexpr ESP_8_BIT_phase_table<sizeof...(I)> ESP_8_BIT_ntscTable(ESP_8_BIT_index_list<I...>)
+{
+  return {{ ESP_8_BIT_ntscEntry(Components::r(I), Components::g(I), Components::b(I), samplesPerCC)... }};
+}
+
+template<typename Components, int... I>
+constexpr ESP_8_BIT_phase_table<sizeof...(I)> ESP_8_BIT_palTable(ESP_8_BIT_index_list<I...>)
+{
+  return {{ ESP_8_BIT_palEntry(Components::r(I & 0xFF), Components::g(I & 0xFF), Components::b(I & 0xFF), I >= 256)... }};
+}
+
+/*
+ * @brief 256 entry NTSC palette of the colors returned by Colors::rgb()
+ */
+template<typename Colors, int samplesPerCC = 4>
+constexpr ESP_8_BIT_phase_table<256> ESP_8_BIT_ntscPalette()
+{
+  return ESP_8_BIT_ntscTable<ESP_8_BIT_RGB888<Colors>, samplesPerCC>(typename ESP_8_BIT_make_index_list<256>::type());
+}
+
+/*
+ * @brief 512 entry PAL palette (two line phases) of the colors returned by
+ * Colors::rgb()
+ */
+template<typename Colors>
+constexpr ESP_8_BIT_phase_table<512> ESP_8_BIT_palPalette()
+{
+  return ESP_8_BIT_palTable<ESP_8_BIT_RGB888<Colors> >(typename ESP_8_BIT_make_index_list<512>::type());
+}
+
+/*
+ * @brief Whether two phase tables differ by no more than maxDelta DAC levels
+ * in any sample. Split in halves to keep constexpr recursion shallow.
+ */
+constexpr bool ESP_8_BIT_sample_close(uint32_t a, uint32_t b, int maxDelta)
+{
+  return ((int)(a & 0xFF) - (int)(b & 0xFF) <= maxDelta) && ((int)(b & 0xFF) - (int)(a & 0xFF) <= maxDelta);
+}
+
+constexpr bool ESP_8_BIT_entry_close(uint32_t a, uint32_t b, int maxDelta)
+{
+  return ESP_8_BIT_sample_close(a, b, maxDelta) && ESP_8_BIT_sample_close(a >> 8, b >> 8, maxDelta) &&
+    ESP_8_BIT_sample_close(a >> 16, b >> 16, maxDelta) && ESP_8_BIT_sample_close(a >> 24, b >> 24, maxDelta);
+}
+
+constexpr bool ESP_8_BIT_tables_close(const uint32_t* a, const uint32_t* b, int count, int maxDelta)
+{
+  return count == 1 ? ESP_8_BIT_entry_close(a[0], b[0], maxDelta) :
+    ESP_8_BIT_tables_close(a, b, count/2, maxDelta) &&
+    ESP_8_BIT_tables_close(a + count/2, b + count/2, count - count/2, maxDelta);
+}
+
+#endif // ESP_8_BIT_PALETTE_H
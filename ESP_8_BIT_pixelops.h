@@ -0,0 +1,243 @@
+/*
+
+ESP_8_BIT RGB332 pixel operations.
+
+Per channel math on rows of RGB332 pixels, such as frame buffer lines from
+getFrameBufferLines(), for effects like fades, additive light, motion blur
+and overlays. Each 32-bit word of four pixels is worked on at once, with
+red, green and blue fields kept apart by masks so no carry or borrow ever
+crosses from one field into the next. Results are the same as doing the
+math on each channel of each pixel. Example, fading the bottom half of the
+screen to half brightness:
+
+  uint8_t** lines = videoOut.getComposite()->getFrameBufferLines();
+  for (int y = 120; y < 240; y++)
+  {
+    ESP_8_BIT_scale(lines[y], 256, 16);
+  }
+
+Rows need not be aligned, pixels up to the first word boundary of the
+destination and after the last are done one at a time. For frame buffers
+of 8 bits per pixel only, not monochrome ones.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+#ifndef ESP_8_BIT_PIXELOPS_H
+#define ESP_8_BIT_PIXELOPS_H
+
+#include <stdint.h>
+#include <string.h>
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Four pixels in a word
+
+/*
+ * @brief Most and least significant bit of the red (bits 7-5), green
+ * (bits 4-2) and blue (bits 1-0) fields of four RGB332 pixels
+ */
+static const uint32_t ESP_8_BIT_RGB332_MSB = 0x92929292;
+static const uint32_t ESP_8_BIT_RGB332_LSB = 0x25252525;
+
+/*
+ * @brief Spread bits at the most significant bit of fields over the whole
+ * field. Blue is only 2 bits wide and must not spill into the next pixel.
+ */
+static inline uint32_t ESP_8_BIT_fillFields(uint32_t msb)
+{
+  return msb | (msb >> 1) | ((msb & 0x90909090) >> 2);
+}
+
+/*
+ * @brief Per channel sum, saturating at full intensity
+ */
+static inline uint32_t ESP_8_BIT_add332(uint32_t a, uint32_t b)
+{
+  // Add below the top bit of each field, which takes the carry but
+  // passes none on, then put the top bits back in
+  uint32_t sum = ((a & ~ESP_8_BIT_RGB332_MSB) + (b & ~ESP_8_BIT_RGB332_MSB)) ^
+    ((a ^ b) & ESP_8_BIT_RGB332_MSB);
+  uint32_t carry = ((a & b) | ((a | b) & ~sum)) & ESP_8_BIT_RGB332_MSB;
+  return sum | ESP_8_BIT_fillFields(carry);
+}
+
+/*
+ * @brief Per channel difference a - b, saturating at zero
+ */
+static inline uint32_t ESP_8_BIT_sub332(uint32_t a, uint32_t b)
+{
+  // Subtract from each field with its top bit set, so none borrows from
+  // the next, then fix up the top bits
+  uint32_t diff = ((a | ESP_8_BIT_RGB332_MSB) - (b & ~ESP_8_BIT_RGB332_MSB)) ^
+    ((a ^ ~b) & ESP_8_BIT_RGB332_MSB);
+  uint32_t borrow = ((~a & b) | (~(a ^ b) & diff)) & ESP_8_BIT_RGB332_MSB;
+  return diff & ~ESP_8_BIT_fillFields(borrow);
+}
+
+/*
+ * @brief Per channel average, rounded down
+ */
+static inline uint32_t ESP_8_BIT_blend332(uint32_t a, uint32_t b)
+{
+  return (a & b) + (((a ^ b) & ~ESP_8_BIT_RGB332_LSB) >> 1);
+}
+
+/*
+ * @brief Each channel multiplied by scale/32, rounded down, scale from 0
+ * to 32, larger values taken as 32. Products of at most 7*32 fit in a
+ * byte, so one multiply does a field of all four pixels.
+ */
+static inline uint32_t ESP_8_BIT_scale332(uint32_t a, uint8_t scale)
+{
+  // Larger products would carry into the next pixel
+  if (scale > 32)
+  {
+    scale = 32;
+  }
+  uint32_t r = ((((a >> 5) & 0x07070707)*scale) >> 5) & 0x07070707;
+  uint32_t g = ((((a >> 2) & 0x07070707)*scale) >> 5) & 0x07070707;
+  uint32_t b = (((a & 0x03030303)*scale) >> 5) & 0x03030303;
+  return r << 5 | g << 2 | b;
+}
+
+/*
+ * @brief 0xFF for each pixel that is not the color key repeated in key32,
+ * 0x00 for each that is
+ */
+static inline uint32_t ESP_8_BIT_keyMask332(uint32_t a, uint32_t key32)
+{
+  uint32_t t = a ^ key32;
+  uint32_t m = (((t & 0x7F7F7F7F) + 0x7F7F7F7F) | t) & 0x80808080;
+  return (m >> 7)*0xFF;
+}
+
+/*
+ * @brief Apply a word operation to n pixels of dst, a word at a time once
+ * dst is aligned. Single pixels go through the same operation in the low
+ * byte of a word.
+ */
+template<typename Op>
+static inline void ESP_8_BIT_rowOp(uint8_t* dst, const uint8_t* src, int n, Op op)
+{
+  for (; n > 0 && ((uintptr_t)dst & 3); n--, dst++, src++)
+  {
+    *dst = (uint8_t)op(*dst, *src);
+  }
+  for (; n >= 4; n -= 4, dst += 4, src += 4)
+  {
+    uint32_t s;
+    memcpy(&s, src, 4);
+    *(uint32_t*)dst = op(*(uint32_t*)dst, s);
+  }
+  for (; n > 0; n--, dst++, src++)
+  {
+    *dst = (uint8_t)op(*dst, *src);
+  }
+}
+
+template<typename Op>
+static inline void ESP_8_BIT_rowOp(uint8_t* dst, int n, Op op)
+{
+  for (; n > 0 && ((uintptr_t)dst & 3); n--, dst++)
+  {
+    *dst = (uint8_t)op(*dst);
+  }
+  for (; n >= 4; n -= 4, dst += 4)
+  {
+    *(uint32_t*)dst = op(*(uint32_t*)dst);
+  }
+  for (; n > 0; n--, dst++)
+  {
+    *dst = (uint8_t)op(*dst);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Rows of pixels
+
+/*
+ * @brief dst = dst + src per channel, saturating. Additive light.
+ */
+static inline void ESP_8_BIT_addSaturate(uint8_t* dst, const uint8_t* src, int n)
+{
+  ESP_8_BIT_rowOp(dst, src, n, [](uint32_t a, uint32_t b) { return ESP_8_BIT_add332(a, b); });
+}
+
+/*
+ * @brief dst = dst - src per channel, saturating at zero
+ */
+static inline void ESP_8_BIT_subSaturate(uint8_t* dst, const uint8_t* src, int n)
+{
+  ESP_8_BIT_rowOp(dst, src, n, [](uint32_t a, uint32_t b) { return ESP_8_BIT_sub332(a, b); });
+}
+
+/*
+ * @brief Add or subtract one color to n pixels per channel, saturating.
+ * Fade towards white or black, tint or flash.
+ */
+static inline void ESP_8_BIT_addColor(uint8_t* dst, uint8_t color, int n)
+{
+  uint32_t color32 = color*0x01010101u;
+  ESP_8_BIT_rowOp(dst, n, [=](uint32_t a) { return ESP_8_BIT_add332(a, color32); });
+}
+
+static inline void ESP_8_BIT_subColor(uint8_t* dst, uint8_t color, int n)
+{
+  uint32_t color32 = color*0x01010101u;
+  ESP_8_BIT_rowOp(dst, n, [=](uint32_t a) { return ESP_8_BIT_sub332(a, color32); });
+}
+
+/*
+ * @brief dst = (dst + src)/2 per channel. Averaging with the previous
+ * frame gives motion blur.
+ */
+static inline void ESP_8_BIT_blend(uint8_t* dst, const uint8_t* src, int n)
+{
+  ESP_8_BIT_rowOp(dst, src, n, [](uint32_t a, uint32_t b) { return ESP_8_BIT_blend332(a, b); });
+}
+
+/*
+ * @brief dst = dst*scale/32 per channel, scale from 0 (black) to 32
+ * (unchanged), larger values taken as 32
+ */
+static inline void ESP_8_BIT_scale(uint8_t* dst, int n, uint8_t scale)
+{
+  ESP_8_BIT_rowOp(dst, n, [=](uint32_t a) { return ESP_8_BIT_scale332(a, scale); });
+}
+
+/*
+ * @brief dst = src wherever src is not the color key. Overlays a layer
+ * with transparent parts.
+ */
+static inline void ESP_8_BIT_composeKey(uint8_t* dst, const uint8_t* src, int n, uint8_t key)
+{
+  uint32_t key32 = key*0x01010101u;
+  ESP_8_BIT_rowOp(dst, src, n, [=](uint32_t a, uint32_t b) {
+    uint32_t m = ESP_8_BIT_keyMask332(b, key32);
+    return (a & ~m) | (b & m);
+  });
+}
+
+#endif // ESP_8_BIT_PIXELOPS_H
@@ -0,0 +1,130 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+Composite Blit Benchmark
+
+Measures the blit kernel of every frame buffer width at 4 and 3 samples
+per color clock with ESP_8_BIT_composite::getBlitCycles(), and prints CPU
+cycles per line next to the line time budget to the serial port. The video
+interrupt also has to generate sync and color burst, draw sprites and run
+raster callbacks within that budget, so a width whose kernel takes a large
+share of it leaves little room for anything else. Then video starts,
+showing the same results as one bar per kernel, green if the kernel takes
+less than half of the line, yellow if less than three quarters, red beyond.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_composite.h>
+
+const bool ntsc = true;
+
+// One line at 240MHz: 63.556us NTSC, 64us PAL
+const uint32_t lineCycles = ntsc ? 15253 : 15360;
+
+const int widths[] = { 128, 160, 192, 256, 320, 384 };
+const int widthCount = sizeof(widths)/sizeof(widths[0]);
+
+// Cycles per line for 4 and 3 samples per color clock, 0 if the width is
+// not available at that rate
+uint32_t cycles[2][widthCount];
+
+ESP_8_BIT_composite videoOut(ntsc);
+
+void report()
+{
+  Serial.printf("Blit cycles per line, line budget %u cycles\n", lineCycles);
+  for (int s = 0; s < 2; s++)
+  {
+    Serial.printf("%d samples per color clock\n", 4 - s);
+    for (int w = 0; w < widthCount; w++)
+    {
+      if (0 == cycles[s][w])
+      {
+        Serial.printf("  %3d pixels: not available\n", widths[w]);
+        continue;
+      }
+      Serial.printf("  %3d pixels: %5u cycles, %3u%% of line\n",
+        widths[w], cycles[s][w], cycles[s][w]*100/lineCycles);
+    }
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  // Blit kernels can only be timed before video starts
+  for (int s = 0; s < 2; s++)
+  {
+    int samples = 4 - s;
+    if (samples == 3 && !ntsc)
+    {
+      break;
+    }
+    videoOut.setSamplesPerColorClock(samples);
+    for (int w = 0; w < widthCount; w++)
+    {
+      // No half color clock pixels at 3 samples per color clock
+      if (samples == 3 && widths[w] > 256)
+      {
+        continue;
+      }
+      cycles[s][w] = videoOut.getBlitCycles(widths[w]);
+    }
+  }
+  videoOut.setSamplesPerColorClock(4);
+  report();
+
+  // One bar per kernel, 4 samples per color clock on top, full screen
+  // width is a whole line. Drawn into both buffers so it stays up.
+  videoOut.begin();
+  for (int frame = 0; frame < 2; frame++)
+  {
+    uint8_t** lines = videoOut.getFrameBufferLines();
+    for (int y = 0; y < 240; y++)
+    {
+      memset(lines[y], 0, 256);
+    }
+    for (int s = 0; s < 2; s++)
+    {
+      for (int w = 0; w < widthCount; w++)
+      {
+        uint32_t c = cycles[s][w];
+        int length = c*256/lineCycles;
+        uint8_t color = c*2 < lineCycles ? 0x1C : (c*4 < lineCycles*3 ? 0xFC : 0xE0);
+        int top = 24 + (s*widthCount + w)*16;
+        for (int y = top; y < top + 10; y++)
+        {
+          memset(lines[y], color, length < 256 ? length : 256);
+        }
+      }
+    }
+    videoOut.waitForFrame();
+  }
+}
+
+void loop() {
+  delay(5000);
+  report();
+}
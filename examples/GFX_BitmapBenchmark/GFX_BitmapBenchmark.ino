@@ -0,0 +1,175 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Bitmap Benchmark
+
+Measures how quickly ESP_8_BIT_GFX draws bitmaps, in megabytes of bitmap
+data per second. A 16-bit RGB565 image is drawn with and without ordered
+dither, next to a native RGB332 image, a grayscale image and 1-bit images
+with and without background color. Each is also timed with the inherited
+Adafruit_GFX version where there is one, which draws a pixel at a time.
+Results are printed to the serial port.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+
+// Create an instance of the graphics library, in 16-bit color to convert
+// RGB565 images
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 16 /* = RGB565 color */);
+
+const int16_t imageWidth = 128;
+const int16_t imageHeight = 96;
+const int passes = 20;
+
+uint16_t rgb565Image[imageWidth*imageHeight];
+uint8_t rgb332Image[imageWidth*imageHeight];
+uint8_t bitImage[imageWidth/8*imageHeight];
+
+enum Kind { RGB565, RGB565_DITHER, RGB332, GRAYSCALE, BITS_OPAQUE, BITS_TRANSPARENT };
+
+// Draw one image, with the inherited Adafruit_GFX version if asked
+void draw(Kind kind, int16_t x, int16_t y, bool inherited)
+{
+  switch (kind)
+  {
+    case RGB565:
+    case RGB565_DITHER:
+      if (inherited)
+      {
+        videoOut.Adafruit_GFX::drawRGBBitmap(x, y, rgb565Image, imageWidth, imageHeight);
+      }
+      else
+      {
+        videoOut.drawRGBBitmap(x, y, rgb565Image, imageWidth, imageHeight);
+      }
+      break;
+    case RGB332:
+      videoOut.drawRGB332Bitmap(x, y, rgb332Image, imageWidth, imageHeight);
+      break;
+    case GRAYSCALE:
+      if (inherited)
+      {
+        videoOut.Adafruit_GFX::drawGrayscaleBitmap(x, y, rgb332Image, imageWidth, imageHeight);
+      }
+      else
+      {
+        videoOut.drawGrayscaleBitmap(x, y, rgb332Image, imageWidth, imageHeight);
+      }
+      break;
+    case BITS_OPAQUE:
+      if (inherited)
+      {
+        videoOut.Adafruit_GFX::drawBitmap(x, y, bitImage, imageWidth, imageHeight, 0xFFFF, 0x001F);
+      }
+      else
+      {
+        videoOut.drawBitmap(x, y, bitImage, imageWidth, imageHeight, 0xFFFF, 0x001F);
+      }
+      break;
+    case BITS_TRANSPARENT:
+      if (inherited)
+      {
+        videoOut.Adafruit_GFX::drawBitmap(x, y, bitImage, imageWidth, imageHeight, 0xFFFF);
+      }
+      else
+      {
+        videoOut.drawBitmap(x, y, bitImage, imageWidth, imageHeight, 0xFFFF);
+      }
+      break;
+  }
+}
+
+// Time a number of passes of images tiled over the screen, partly off the
+// right and bottom edges, print megabytes of bitmap data per second
+void report(const char* name, Kind kind, bool inherited)
+{
+  uint32_t bytesPerImage = RGB565 == kind || RGB565_DITHER == kind ?
+    imageWidth*imageHeight*2 : BITS_OPAQUE == kind || BITS_TRANSPARENT == kind ?
+    sizeof(bitImage) : imageWidth*imageHeight;
+  uint32_t images = 0;
+
+  videoOut.setBitmapDither(RGB565_DITHER == kind);
+  uint32_t start = micros();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (int16_t y = 0; y < videoOut.height(); y += imageHeight)
+    {
+      for (int16_t x = 0; x < videoOut.width(); x += imageWidth, images++)
+      {
+        draw(kind, x, y, inherited);
+      }
+    }
+  }
+  uint32_t elapsed = micros() - start;
+  videoOut.setBitmapDither(false);
+
+  Serial.printf("  %-22s %7.2f MB/s\n", name,
+    (double)images*bytesPerImage/elapsed);
+}
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+
+  // Color gradients, where dither makes a visible difference, and a
+  // pattern of short and long runs of bits
+  for (int16_t y = 0; y < imageHeight; y++)
+  {
+    for (int16_t x = 0; x < imageWidth; x++)
+    {
+      uint8_t r = x*31/(imageWidth - 1);
+      uint8_t g = y*63/(imageHeight - 1);
+      uint8_t b = 31 - r;
+      rgb565Image[y*imageWidth + x] = r << 11 | g << 5 | b;
+      rgb332Image[y*imageWidth + x] = videoOut.convertRGB565toRGB332(rgb565Image[y*imageWidth + x]);
+    }
+  }
+  for (int i = 0; i < (int)sizeof(bitImage); i++)
+  {
+    bitImage[i] = (i % 3) ? i*37 : 0xFF;
+  }
+}
+
+void loop() {
+  for (uint8_t rotation = 0; rotation < 4; rotation++)
+  {
+    videoOut.setRotation(rotation);
+    Serial.printf("Rotation %d\n", rotation);
+    report("drawRGBBitmap", RGB565, false);
+    report("  dithered", RGB565_DITHER, false);
+    report("  inherited", RGB565, true);
+    report("drawRGB332Bitmap", RGB332, false);
+    report("drawGrayscaleBitmap", GRAYSCALE, false);
+    report("  inherited", GRAYSCALE, true);
+    report("drawBitmap opaque", BITS_OPAQUE, false);
+    report("  inherited", BITS_OPAQUE, true);
+    report("drawBitmap transparent", BITS_TRANSPARENT, false);
+    report("  inherited", BITS_TRANSPARENT, true);
+  }
+  videoOut.setRotation(0);
+  videoOut.waitForFrame();
+  delay(2000);
+}
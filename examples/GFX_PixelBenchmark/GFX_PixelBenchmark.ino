@@ -0,0 +1,76 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Pixel Benchmark
+
+Measures how many pixels per second ESP_8_BIT_GFX::drawPixel() puts in the
+frame buffer in each of the four rotations, and prints the results to the
+serial port. Every pixel of the screen is drawn one at a time, the way
+Adafruit GFX draws lines, circles and text.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+
+// Create an instance of the graphics library
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 8 /* = RGB332 color */);
+
+// Adafruit GFX calls drawPixel() through its base class, so do the same
+Adafruit_GFX* gfx = &videoOut;
+
+const int passes = 10;
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+}
+
+void loop() {
+  for (uint8_t r = 0; r < 4; r++)
+  {
+    videoOut.setRotation(r);
+    int16_t w = videoOut.width();
+    int16_t h = videoOut.height();
+
+    uint32_t start = micros();
+    for (int pass = 0; pass < passes; pass++)
+    {
+      for (int16_t y = 0; y < h; y++)
+      {
+        for (int16_t x = 0; x < w; x++)
+        {
+          gfx->drawPixel(x, y, x ^ y ^ pass);
+        }
+      }
+    }
+    uint32_t elapsed = micros() - start;
+
+    uint32_t pixels = (uint32_t)w*h*passes;
+    Serial.printf("Rotation %d: %u pixels in %u us, %u pixels/s\n",
+      r, pixels, elapsed, (uint32_t)((uint64_t)pixels*1000000/elapsed));
+  }
+  videoOut.waitForFrame();
+  delay(2000);
+}
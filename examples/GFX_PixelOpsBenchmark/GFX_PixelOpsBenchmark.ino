@@ -0,0 +1,182 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Pixel Ops Benchmark
+
+Checks the four pixels at a time RGB332 operations of ESP_8_BIT_pixelops.h
+against plain per pixel versions of the same math on random rows of every
+alignment, then measures how quickly each goes over the whole frame
+buffer, in megabytes per second, next to the per pixel version. Results
+are printed to the serial port.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+#include <ESP_8_BIT_pixelops.h>
+
+// Create an instance of the graphics library
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 8 /* = RGB332 color */);
+
+const int passes = 10;
+
+// Second image to combine with the frame buffer, a line at a time
+uint8_t source[256];
+
+// Per pixel versions of the same math, one channel at a time
+uint8_t pack(int r, int g, int b)
+{
+  return min(max(r, 0), 7) << 5 | min(max(g, 0), 7) << 2 | min(max(b, 0), 3);
+}
+
+uint8_t addPixel(uint8_t a, uint8_t b)
+{
+  return pack((a >> 5) + (b >> 5), ((a >> 2) & 7) + ((b >> 2) & 7), (a & 3) + (b & 3));
+}
+
+uint8_t subPixel(uint8_t a, uint8_t b)
+{
+  return pack((a >> 5) - (b >> 5), ((a >> 2) & 7) - ((b >> 2) & 7), (a & 3) - (b & 3));
+}
+
+uint8_t blendPixel(uint8_t a, uint8_t b)
+{
+  return pack(((a >> 5) + (b >> 5))/2, (((a >> 2) & 7) + ((b >> 2) & 7))/2, ((a & 3) + (b & 3))/2);
+}
+
+uint8_t scalePixel(uint8_t a, uint8_t scale)
+{
+  return pack((a >> 5)*scale/32, ((a >> 2) & 7)*scale/32, (a & 3)*scale/32);
+}
+
+enum Op { ADD, SUB, BLEND, SCALE, COMPOSE, ADD_COLOR, SUB_COLOR };
+const char* opNames[] = { "addSaturate", "subSaturate", "blend", "scale",
+  "composeKey", "addColor", "subColor" };
+const uint8_t scale = 24;
+const uint8_t color = 0x49;
+
+// Apply an operation to n pixels, four at a time or one at a time
+void apply(Op op, uint8_t* dst, const uint8_t* src, int n, bool perPixel)
+{
+  if (!perPixel)
+  {
+    switch (op)
+    {
+      case ADD: ESP_8_BIT_addSaturate(dst, src, n); break;
+      case SUB: ESP_8_BIT_subSaturate(dst, src, n); break;
+      case BLEND: ESP_8_BIT_blend(dst, src, n); break;
+      case SCALE: ESP_8_BIT_scale(dst, n, scale); break;
+      case COMPOSE: ESP_8_BIT_composeKey(dst, src, n, color); break;
+      case ADD_COLOR: ESP_8_BIT_addColor(dst, color, n); break;
+      case SUB_COLOR: ESP_8_BIT_subColor(dst, color, n); break;
+    }
+    return;
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    switch (op)
+    {
+      case ADD: dst[i] = addPixel(dst[i], src[i]); break;
+      case SUB: dst[i] = subPixel(dst[i], src[i]); break;
+      case BLEND: dst[i] = blendPixel(dst[i], src[i]); break;
+      case SCALE: dst[i] = scalePixel(dst[i], scale); break;
+      case COMPOSE: dst[i] = src[i] == color ? dst[i] : src[i]; break;
+      case ADD_COLOR: dst[i] = addPixel(dst[i], color); break;
+      case SUB_COLOR: dst[i] = subPixel(dst[i], color); break;
+    }
+  }
+}
+
+// Compare both versions on random rows at every alignment
+bool check(Op op)
+{
+  uint8_t fast[80];
+  uint8_t slow[80];
+  uint8_t src[80];
+  for (int trial = 0; trial < 2000; trial++)
+  {
+    int offset = random(4);
+    int srcOffset = random(4);
+    int n = random(1, 76);
+    for (int i = 0; i < 80; i++)
+    {
+      fast[i] = slow[i] = random(256);
+      src[i] = random(4) ? random(256) : color;
+    }
+    apply(op, fast + offset, src + srcOffset, n, false);
+    apply(op, slow + offset, src + srcOffset, n, true);
+    if (memcmp(fast, slow, sizeof(fast)))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Time passes over the frame buffer, print megabytes per second
+void report(Op op, bool perPixel)
+{
+  uint8_t** lines = videoOut.getComposite()->getFrameBufferLines();
+  int16_t width = videoOut.getComposite()->getWidth();
+  int16_t height = videoOut.getComposite()->getHeight();
+
+  uint32_t start = micros();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (int16_t y = 0; y < height; y++)
+    {
+      apply(op, lines[y], source, width, perPixel);
+    }
+  }
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("  %-14s %7.2f MB/s\n", perPixel ? "  per pixel" : opNames[op],
+    (double)passes*width*height/elapsed);
+}
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+
+  for (int i = 0; i < 256; i++)
+  {
+    source[i] = i;
+  }
+}
+
+void loop() {
+  for (int op = ADD; op <= SUB_COLOR; op++)
+  {
+    Serial.printf("%s %s\n", opNames[op], check((Op)op) ? "matches" : "DIFFERS");
+  }
+  for (int op = ADD; op <= SUB_COLOR; op++)
+  {
+    videoOut.fillScreen(0x6D);
+    report((Op)op, false);
+    report((Op)op, true);
+  }
+  videoOut.waitForFrame();
+  delay(2000);
+}
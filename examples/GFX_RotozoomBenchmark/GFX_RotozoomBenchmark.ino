@@ -0,0 +1,160 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Rotozoom Benchmark
+
+Measures full screen rotozoom frame rate of ESP_8_BIT_GFX. A 64x64 texture
+is repeated across the screen with fillRectRotatedBitmap() at a changing
+angle and scale, optionally with a rotated sprite drawn over it with a
+transparent color key by drawRotatedBitmap(). The same rotozoom computed in
+floating point and drawn a pixel at a time with drawPixel() is timed for
+comparison. Results are printed to the serial port.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+
+// Create an instance of the graphics library
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 8 /* = RGB332 color */);
+
+// Repeated texture, size must be a power of two
+const int16_t textureSize = 64;
+uint8_t texture[textureSize*textureSize];
+
+// Sprite with transparent corners drawn over the rotozoom
+const int16_t spriteSize = 32;
+uint8_t sprite[spriteSize*spriteSize];
+
+// Transparent color of the sprite, magenta
+const uint8_t colorKey = 0xE3;
+
+const int frames = 20;
+
+// Angle in degrees and scale for one frame of animation
+float frameAngle(int frame)
+{
+  return frame*7.0f;
+}
+
+float frameScale(int frame)
+{
+  return 1.5f + sinf(frame*0.3f);
+}
+
+// Draw one rotozoom frame a pixel at a time with floating point math
+void drawRotozoomPixels(float degrees, float scale)
+{
+  float radians = degrees*PI/180;
+  float a = cosf(radians)/scale;
+  float b = sinf(radians)/scale;
+  float cx = videoOut.width()/2;
+  float cy = videoOut.height()/2;
+  for (int16_t y = 0; y < videoOut.height(); y++)
+  {
+    for (int16_t x = 0; x < videoOut.width(); x++)
+    {
+      float dx = x + 0.5f - cx;
+      float dy = y + 0.5f - cy;
+      int16_t u = (int16_t)floorf(textureSize/2 + a*dx + b*dy) & (textureSize-1);
+      int16_t v = (int16_t)floorf(textureSize/2 - b*dx + a*dy) & (textureSize-1);
+      videoOut.drawPixel(x, y, texture[v*textureSize + u]);
+    }
+  }
+}
+
+// Time a number of rotozoom frames, print frames per second and
+// milliseconds per frame
+void report(const char* name, bool withSprite, bool pixels)
+{
+  uint32_t start = micros();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    float degrees = frameAngle(frame);
+    float scale = frameScale(frame);
+    if (pixels)
+    {
+      drawRotozoomPixels(degrees, scale);
+    }
+    else
+    {
+      videoOut.fillRectRotatedBitmap(0, 0, videoOut.width(), videoOut.height(),
+        texture, textureSize, textureSize,
+        textureSize/2, textureSize/2, degrees, scale);
+    }
+    if (withSprite)
+    {
+      videoOut.drawRotatedBitmap(videoOut.width()/2, videoOut.height()/2,
+        sprite, spriteSize, spriteSize, -2*degrees, 2.0f, colorKey);
+    }
+  }
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("  %-22s %8.1f frames/s %6.2f ms/frame\n", name,
+    frames*1000000.0/elapsed, elapsed/1000.0/frames);
+}
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+
+  // Checkerboard of color gradients
+  for (int16_t j = 0; j < textureSize; j++)
+  {
+    for (int16_t i = 0; i < textureSize; i++)
+    {
+      uint8_t red = i*8/textureSize;
+      uint8_t green = j*8/textureSize;
+      uint8_t blue = ((i ^ j) & 16) ? 3 : 0;
+      texture[j*textureSize + i] = (red << 5) | (green << 2) | blue;
+    }
+  }
+
+  // Yellow ring on transparent background
+  for (int16_t j = 0; j < spriteSize; j++)
+  {
+    for (int16_t i = 0; i < spriteSize; i++)
+    {
+      int16_t dx = i - spriteSize/2;
+      int16_t dy = j - spriteSize/2;
+      int16_t r2 = dx*dx + dy*dy;
+      bool ring = r2 < spriteSize*spriteSize/4 && r2 >= spriteSize*spriteSize/16;
+      sprite[j*spriteSize + i] = ring || dx == 0 ? 0xFC : colorKey;
+    }
+  }
+}
+
+void loop() {
+  for (uint8_t rotation = 0; rotation < 4; rotation++)
+  {
+    videoOut.setRotation(rotation);
+    Serial.printf("Rotation %d\n", rotation);
+    report("rotozoom", false, false);
+    report("rotozoom, color key", true, false);
+    report("drawPixel", false, true);
+  }
+  videoOut.setRotation(0);
+  videoOut.waitForFrame();
+  delay(2000);
+}
@@ -0,0 +1,154 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Shape Benchmark
+
+Measures how quickly ESP_8_BIT_GFX draws the shapes used by the
+GFX_Screen_Fillers example: filled rectangle, filled circle, and screens
+full of vertical and horizontal lines, in each of the four rotations.
+Filled triangle, circle and rounded rectangle are also timed with their
+inherited Adafruit_GFX versions, followed by a filled polygon.
+Results are printed to the serial port in pixels per second. Then lines
+per second of random line segments, long ones across the screen and short
+ones up to 10 pixels in each direction.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+
+// Create an instance of the graphics library
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 8 /* = RGB332 color */);
+
+const int passes = 20;
+
+// Time a number of passes of a drawing function, print pixels per second
+void report(const char* name, uint32_t pixels, void (*draw)(int16_t w, int16_t h))
+{
+  int16_t w = videoOut.width();
+  int16_t h = videoOut.height();
+
+  uint32_t start = micros();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    draw(w, h);
+  }
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("  %-14s %9u pixels/s\n", name,
+    (uint32_t)((uint64_t)pixels*passes*1000000/elapsed));
+}
+
+// Random line segments, long and short
+const int segmentCount = 1000;
+int16_t segments[2][segmentCount][4];
+
+// Time a number of passes drawing one set of segments, print lines per second
+void reportLines(const char* name, int16_t (*segment)[4])
+{
+  uint32_t start = micros();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    for (int i = 0; i < segmentCount; i++)
+    {
+      videoOut.drawLine(segment[i][0], segment[i][1], segment[i][2], segment[i][3], i);
+    }
+  }
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("  %-14s %9u lines/s\n", name,
+    (uint32_t)((uint64_t)segmentCount*passes*1000000/elapsed));
+}
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+
+  for (int i = 0; i < segmentCount; i++)
+  {
+    int16_t x = random(256);
+    int16_t y = random(240);
+    segments[0][i][0] = x;
+    segments[0][i][1] = y;
+    segments[0][i][2] = random(256);
+    segments[0][i][3] = random(240);
+    segments[1][i][0] = x;
+    segments[1][i][1] = y;
+    segments[1][i][2] = x + random(-10, 11);
+    segments[1][i][3] = y + random(-10, 11);
+  }
+}
+
+void loop() {
+  for (uint8_t r = 0; r < 4; r++)
+  {
+    videoOut.setRotation(r);
+    int16_t w = videoOut.width();
+    int16_t h = videoOut.height();
+    Serial.printf("Rotation %d\n", r);
+
+    report("fillRect", w*h, [](int16_t w, int16_t h) {
+      videoOut.fillRect(0, 0, w, h, 0x1C);
+    });
+    report("fillCircle", 31416, [](int16_t w, int16_t h) {
+      videoOut.fillCircle(w/2, h/2, 100, 0xE0);
+    });
+    report("  inherited", 31416, [](int16_t w, int16_t h) {
+      videoOut.Adafruit_GFX::fillCircle(w/2, h/2, 100, 0xE0);
+    });
+    report("fillTriangle", w*h/2, [](int16_t w, int16_t h) {
+      videoOut.fillTriangle(0, 0, w-1, h/2, 0, h-1, 0x1C);
+    });
+    report("  inherited", w*h/2, [](int16_t w, int16_t h) {
+      videoOut.Adafruit_GFX::fillTriangle(0, 0, w-1, h/2, 0, h-1, 0x1C);
+    });
+    report("fillRoundRect", w*h, [](int16_t w, int16_t h) {
+      videoOut.fillRoundRect(0, 0, w, h, 20, 0x03);
+    });
+    report("  inherited", w*h, [](int16_t w, int16_t h) {
+      videoOut.Adafruit_GFX::fillRoundRect(0, 0, w, h, 20, 0x03);
+    });
+    report("fillPolygon", w*h/4, [](int16_t w, int16_t h) {
+      // Arrowhead, a concave quadrilateral
+      int16_t points[] = { 0, 0, w, h/2, 0, h, w/2, h/2 };
+      videoOut.fillPolygon(points, 4, 0xFC);
+    });
+    report("drawFastVLine", w*h, [](int16_t w, int16_t h) {
+      for (int16_t x = 0; x < w; x++)
+      {
+        videoOut.drawFastVLine(x, 0, h, x);
+      }
+    });
+    report("drawFastHLine", w*h, [](int16_t w, int16_t h) {
+      for (int16_t y = 0; y < h; y++)
+      {
+        videoOut.drawFastHLine(0, y, w, y);
+      }
+    });
+    reportLines("long lines", segments[0]);
+    reportLines("short lines", segments[1]);
+  }
+  videoOut.waitForFrame();
+  delay(2000);
+}
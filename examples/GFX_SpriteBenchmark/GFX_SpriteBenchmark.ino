@@ -0,0 +1,140 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Sprite Benchmark
+
+Measures how quickly ESP_8_BIT_GFX draws 16x16 sprites from a sprite
+sheet with drawSprite(), in sprites per second and as time per frame of
+300 sprites. Opaque sprites, sprites with a transparent color key and
+mirrored sprites are each timed, then the same sprites drawn a pixel at a
+time with drawPixel() for comparison. Results are printed to the serial
+port.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+
+// Create an instance of the graphics library
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 8 /* = RGB332 color */);
+
+// Sprite sheet of 4 by 4 sprites, 16x16 pixels each
+const int16_t spriteSize = 16;
+const int16_t sheetWidth = 4*spriteSize;
+uint8_t sheet[sheetWidth*sheetWidth];
+
+// Transparent color of the sprite sheet, magenta
+const uint8_t colorKey = 0xE3;
+
+const int sprites = 300;
+const int frames = 20;
+int16_t spriteX[sprites];
+int16_t spriteY[sprites];
+
+// Draw one sprite from the sheet a pixel at a time
+void drawSpritePixels(int16_t x, int16_t y, int16_t sx, int16_t sy)
+{
+  for (int16_t j = 0; j < spriteSize; j++)
+  {
+    for (int16_t i = 0; i < spriteSize; i++)
+    {
+      uint8_t color = sheet[(sy + j)*sheetWidth + sx + i];
+      if (color != colorKey)
+      {
+        videoOut.drawPixel(x + i, y + j, color);
+      }
+    }
+  }
+}
+
+// Time a number of frames of sprites, print sprites per second and
+// milliseconds per frame
+void report(const char* name, int16_t key, uint8_t flip, bool pixels)
+{
+  uint32_t start = micros();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    for (int i = 0; i < sprites; i++)
+    {
+      int16_t sx = (i & 3)*spriteSize;
+      int16_t sy = ((i >> 2) & 3)*spriteSize;
+      if (pixels)
+      {
+        drawSpritePixels(spriteX[i], spriteY[i], sx, sy);
+      }
+      else
+      {
+        videoOut.drawSprite(spriteX[i], spriteY[i], sheet, sheetWidth,
+          sx, sy, spriteSize, spriteSize, key, flip);
+      }
+    }
+  }
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("  %-22s %8u sprites/s %6.2f ms/frame\n", name,
+    (uint32_t)((uint64_t)sprites*frames*1000000/elapsed),
+    elapsed/1000.0/frames);
+}
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+
+  // Each sprite a filled circle of its own color on transparent corners
+  for (int16_t j = 0; j < sheetWidth; j++)
+  {
+    for (int16_t i = 0; i < sheetWidth; i++)
+    {
+      int16_t dx = i % spriteSize - spriteSize/2;
+      int16_t dy = j % spriteSize - spriteSize/2;
+      uint8_t color = (j/spriteSize*4 + i/spriteSize)*16 + 8;
+      sheet[j*sheetWidth + i] = dx*dx + dy*dy < spriteSize*spriteSize/4 ?
+        color : colorKey;
+    }
+  }
+
+  // Scatter sprites over the screen, some partly off the edges
+  for (int i = 0; i < sprites; i++)
+  {
+    spriteX[i] = random(-spriteSize/2, videoOut.width() - spriteSize/2);
+    spriteY[i] = random(-spriteSize/2, videoOut.height() - spriteSize/2);
+  }
+}
+
+void loop() {
+  for (uint8_t rotation = 0; rotation < 4; rotation++)
+  {
+    videoOut.setRotation(rotation);
+    videoOut.fillScreen(0);
+    Serial.printf("Rotation %d\n", rotation);
+    report("opaque", -1, 0, false);
+    report("color key", colorKey, 0, false);
+    report("color key, mirrored", colorKey,
+      ESP_8_BIT_GFX::SPRITE_FLIP_X | ESP_8_BIT_GFX::SPRITE_FLIP_Y, false);
+    report("drawPixel", colorKey, 0, true);
+  }
+  videoOut.setRotation(0);
+  videoOut.waitForFrame();
+  delay(2000);
+}
@@ -0,0 +1,157 @@
+/*
+
+Example for ESP_8_BIT color composite video generator library on ESP32.
+Connect GPIO25 to signal line, usually the center of composite video plug.
+
+GFX Text Benchmark
+
+Measures how quickly ESP_8_BIT_GFX draws text in the classic built-in
+font, in characters per second, for text sizes 1 to 4. Opaque text (with
+a background color) and transparent text are each timed with the glyph
+cache of ESP_8_BIT_GFX and with the inherited Adafruit_GFX drawChar().
+Then the same for proportional FreeSans fonts from the Adafruit GFX
+library at 9, 18 and 24 points. Results are printed to the serial port.
+
+Copyright (c) Roger Cheng
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+#include <ESP_8_BIT_GFX.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/FreeSans18pt7b.h>
+#include <Fonts/FreeSans24pt7b.h>
+
+// Create an instance of the graphics library
+ESP_8_BIT_GFX videoOut(true /* = NTSC */, 8 /* = RGB332 color */);
+
+const char text[] = "The quick brown fox jumps over the lazy dog. 0123456789";
+const int passes = 20;
+
+// Time a number of passes over the screen of text, print characters per
+// second
+void report(const char* name, uint8_t size, uint16_t bg, bool inherited)
+{
+  int16_t columns = videoOut.width()/(6*size);
+  int16_t rows = videoOut.height()/(8*size);
+  int chars = 0;
+
+  uint32_t start = micros();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    const char* c = text;
+    for (int16_t row = 0; row < rows; row++)
+    {
+      for (int16_t column = 0; column < columns; column++, chars++)
+      {
+        if (inherited)
+        {
+          videoOut.Adafruit_GFX::drawChar(column*6*size, row*8*size, *c, 0xFF, bg, size);
+        }
+        else
+        {
+          videoOut.drawChar(column*6*size, row*8*size, *c, 0xFF, bg, size);
+        }
+        if (0 == *++c)
+        {
+          c = text;
+        }
+      }
+    }
+  }
+  uint32_t elapsed = micros() - start;
+
+  Serial.printf("  %-22s %9u chars/s\n", name,
+    (uint32_t)((uint64_t)chars*1000000/elapsed));
+}
+
+// Time a number of passes over the screen of text in a custom font, print
+// characters per second
+void reportFont(const char* name, const GFXfont* font, bool inherited)
+{
+  uint8_t advance = pgm_read_byte(&font->yAdvance);
+  int chars = 0;
+
+  videoOut.setFont(font);
+  uint32_t start = micros();
+  for (int pass = 0; pass < passes; pass++)
+  {
+    const char* c = text;
+    for (int16_t y = advance; y < videoOut.height(); y += advance)
+    {
+      for (int16_t x = 0;; chars++)
+      {
+        const GFXglyph* glyph = &font->glyph[*c - font->first];
+        uint8_t xAdvance = pgm_read_byte(&glyph->xAdvance);
+        if (x + xAdvance > videoOut.width())
+        {
+          break;
+        }
+        if (inherited)
+        {
+          videoOut.Adafruit_GFX::drawChar(x, y, *c, 0xFF, 0xFF, 1);
+        }
+        else
+        {
+          videoOut.drawChar(x, y, *c, 0xFF, 0xFF, 1);
+        }
+        x += xAdvance;
+        if (0 == *++c)
+        {
+          c = text;
+        }
+      }
+    }
+  }
+  uint32_t elapsed = micros() - start;
+  videoOut.setFont(NULL);
+
+  Serial.printf("  %-22s %9u chars/s\n", name,
+    (uint32_t)((uint64_t)chars*1000000/elapsed));
+}
+
+void setup() {
+  Serial.begin(115200);
+  videoOut.begin();
+
+  // Room for every glyph of the text at size 4, the default 8192 bytes
+  // run out and glyphs are expanded again each time they come around.
+  videoOut.setGlyphCacheSize(16384);
+}
+
+void loop() {
+  for (uint8_t size = 1; size <= 4; size++)
+  {
+    Serial.printf("Text size %d\n", size);
+    report("opaque", size, 0x03, false);
+    report("  inherited", size, 0x03, true);
+    report("transparent", size, 0xFF, false);
+    report("  inherited", size, 0xFF, true);
+  }
+  Serial.printf("FreeSans\n");
+  reportFont("9pt", &FreeSans9pt7b, false);
+  reportFont("  inherited", &FreeSans9pt7b, true);
+  reportFont("18pt", &FreeSans18pt7b, false);
+  reportFont("  inherited", &FreeSans18pt7b, true);
+  reportFont("24pt", &FreeSans24pt7b, false);
+  reportFont("  inherited", &FreeSans24pt7b, true);
+  videoOut.waitForFrame();
+  delay(2000);
+}
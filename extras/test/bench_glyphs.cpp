@@ -0,0 +1,126 @@
+/*
+
+Custom GFXfont glyphs drawn by ESP_8_BIT_GFX::drawChar() as decoded bit runs,
+against the inherited Adafruit_GFX::drawChar() going through drawPixel().
+
+The FreeSans fonts timed by examples/GFX_TextBenchmark on hardware are not
+part of this repository, so the fonts here are synthetic: rings, every other
+one with a vertical bar, with glyph boxes about the size of FreeSans 9, 18
+and 24 point capitals. Stroke width grows with size as it does in FreeSans.
+Numbers are host characters per second, they show how the two paths compare
+for glyphs of that size, not what real fonts do on an ESP32.
+
+Fails if decoded runs are slower than the inherited path at 18 or 24 point.
+
+*/
+
+#include "host.h"
+#include <math.h>
+#include "ESP_8_BIT_GFX.h"
+
+static uint8_t bitmap[32768];
+static GFXglyph glyphs[95];
+static GFXfont font = { bitmap, glyphs, 32, 126, 0 };
+
+// Rings of stroke pixels in glyph boxes width wide and height tall, a few
+// narrower for some proportional spacing
+static void make_font(int width, int height, double stroke)
+{
+  int offset = 0;
+  for (int i = 0; i < 95; i++)
+  {
+    GFXglyph& glyph = glyphs[i];
+    glyph.bitmapOffset = offset;
+    glyph.width = width - i % 3;
+    glyph.height = height;
+    glyph.xAdvance = width + 2;
+    glyph.xOffset = 1;
+    glyph.yOffset = -height;
+
+    int bytes = (glyph.width*height + 7)/8;
+    memset(bitmap + offset, 0, bytes);
+    int bit = 0;
+    for (int y = 0; y < height; y++)
+    {
+      for (int x = 0; x < glyph.width; x++, bit++)
+      {
+        double dx = (x + 0.5 - glyph.width/2.0)/(glyph.width/2.0);
+        double dy = (y + 0.5 - height/2.0)/(height/2.0);
+        double d = sqrt(dx*dx + dy*dy);
+        bool ring = d <= 1 && d >= 1 - stroke*2/glyph.width;
+        bool bar = (i & 1) && fabs(dx) < stroke/glyph.width;
+        if (ring || bar)
+        {
+          bitmap[offset + bit/8] |= 0x80 >> (bit & 7);
+        }
+      }
+    }
+    offset += bytes;
+  }
+  font.yAdvance = height + 4;
+}
+
+// Thousands of characters per second, best of a few runs
+static double kchars(ESP_8_BIT_GFX& gfx, bool inherited)
+{
+  const int chars = 2000;
+  double best = 0;
+  for (int run = 0; run < 5; run++)
+  {
+    double start = host_seconds();
+    for (int i = 0; i < chars; i++)
+    {
+      int x = (i*23) % 200;
+      int y = 40 + (i*7) % 160;
+      unsigned char c = 32 + i % 95;
+      if (inherited)
+      {
+        gfx.Adafruit_GFX::drawChar(x, y, c, 0xFF, 0xFF, 1, 1);
+      }
+      else
+      {
+        gfx.drawChar(x, y, c, 0xFF, 0xFF, 1);
+      }
+    }
+    double rate = chars/(host_seconds() - start)/1000;
+    if (rate > best)
+    {
+      best = rate;
+    }
+  }
+  return best;
+}
+
+int main()
+{
+  // Glyph box width, height and stroke of FreeSans sized capitals
+  const struct { const char* name; int width; int height; double stroke; } sizes[] = {
+    { "9pt", 9, 13, 1 },
+    { "18pt", 20, 25, 2 },
+    { "24pt", 27, 33, 3 },
+  };
+
+  // Kept for the life of the program, as it keeps its own video instance
+  ESP_8_BIT_GFX& gfx = *new ESP_8_BIT_GFX(true, 8);
+  gfx.begin();
+  gfx.setFont(&font);
+
+  for (const auto& size : sizes)
+  {
+    make_font(size.width, size.height, size.stroke);
+    for (int rotation = 0; rotation < 2; rotation++)
+    {
+      gfx.setRotation(rotation);
+      double runs = kchars(gfx, false);
+      double inherited = kchars(gfx, true);
+      printf("%-5s rotation %d  decoded runs %6.0f kchars/s, inherited %6.0f kchars/s\n",
+        size.name, rotation, runs, inherited);
+      if (size.width > 9)
+      {
+        CHECK(runs >= inherited, "decoded runs slower at %s", size.name);
+      }
+    }
+  }
+
+  return host_result("bench_glyphs");
+}
@@ -0,0 +1,102 @@
+/*
+
+Per-line cost of tile mode in the video ISR. Tile mode does everything
+frame buffer mode does for a line, plus tile_line() assembling the line from
+the map first. So it fits the ISR line budget if tile_line() is small next
+to blit(), the encode work every frame buffer line already pays. Both are
+timed here on the host, as well as all of video_isr() per active line, for
+the scroll offsets that take different paths: whole tiles, 4 pixel steps,
+and odd offsets that need realigning.
+
+Fails if assembling a tile line costs more than half of encoding it.
+
+*/
+
+#include "host.h"
+
+// Included rather than linked to reach tile_line() and blit()
+#include "ESP_8_BIT_composite.cpp"
+
+static DRAM_ATTR uint32_t tileWords[256*ESP_8_BIT_TILE_BYTES/4];
+static uint8_t tileMap[ESP_8_BIT_TILE_MAP_WIDTH*ESP_8_BIT_TILE_MAP_HEIGHT];
+static uint8_t bitmapLine[256];
+static volatile uint32_t sink;
+
+static const int rounds = 20000;
+
+// Nanoseconds per call of one line's work, best of a few runs
+template<typename Work>
+static double time_line(Work work)
+{
+  double best = 1e9;
+  for (int run = 0; run < 5; run++)
+  {
+    double start = host_seconds();
+    for (int i = 0; i < rounds; i++)
+    {
+      work(i);
+    }
+    double ns = (host_seconds() - start)*1e9/rounds;
+    if (ns < best)
+    {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+int main()
+{
+  uint8_t* tiles = (uint8_t*)tileWords;
+  for (int t = 0; t < 256; t++)
+  {
+    for (int p = 0; p < ESP_8_BIT_TILE_BYTES; p++)
+    {
+      tiles[t*ESP_8_BIT_TILE_BYTES + p] = t*7 + p*13;
+    }
+  }
+  for (int i = 0; i < ESP_8_BIT_TILE_MAP_WIDTH*ESP_8_BIT_TILE_MAP_HEIGHT; i++)
+  {
+    tileMap[i] = i*37 + 5;
+  }
+  for (int i = 0; i < 256; i++)
+  {
+    bitmapLine[i] = i*3;
+  }
+
+  ESP_8_BIT_composite video(true);
+  video.setTileMode(tiles, tileMap);
+  video.begin();
+
+  double blitNs = time_line([](int i) {
+    blit(bitmapLine, host_line + _active_start, _palette);
+    sink += host_line[_active_start + (i & 255)];
+  });
+  printf("blit() 256 pixels: %.0f ns/line\n", blitNs);
+
+  static const int scrollX[] = {0, 4, 3};
+  static const char* scrollName[] = {"whole tiles", "4 pixel step", "odd offset"};
+  double worst = 0;
+  for (int s = 0; s < 3; s++)
+  {
+    video.setTileScroll(scrollX[s], 5);
+    host_lines(_line_count);
+    CHECK(_tileScrollX == scrollX[s], "scroll %d not applied", scrollX[s]);
+
+    double tileNs = time_line([](int i) {
+      sink += tile_line(i % 240)[i & 255];
+    });
+    double isrNs = time_line([](int i) {
+      video_isr(host_line);
+    });
+    printf("%-13s tile_line() %4.0f ns/line (%3.0f%% of blit), video_isr() %4.0f ns/line average\n",
+      scrollName[s], tileNs, 100*tileNs/blitNs, isrNs);
+    if (tileNs > worst)
+    {
+      worst = tileNs;
+    }
+  }
+
+  CHECK(worst <= blitNs/2, "tile line assembly %.0f ns against %.0f ns blit", worst, blitNs);
+  return host_result("bench_tile_lines");
+}
@@ -0,0 +1,39 @@
+/*
+
+Definitions behind stub/Arduino.h and host.h for the ESP_8_BIT host tests.
+
+*/
+
+#include "host.h"
+#include <stdarg.h>
+
+uint32_t host_ccount = 0;
+host_i2s_t I2S0;
+void (*host_wait_hook)() = NULL;
+
+uint16_t host_line[2048];
+int host_failures = 0;
+
+void host_log(const char* tag, const char* format, ...)
+{
+  if (getenv("ESP_8_BIT_LOG"))
+  {
+    va_list args;
+    va_start(args, format);
+    printf("%s: ", tag);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+  }
+}
+
+int host_result(const char* name)
+{
+  if (host_failures)
+  {
+    printf("%s: %d check(s) failed\n", name, host_failures);
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
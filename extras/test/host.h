@@ -0,0 +1,53 @@
+/*
+
+Shared pieces of the ESP_8_BIT host tests: a video line buffer fed to
+video_isr() as the DMA would, and a minimal check macro.
+
+*/
+
+#ifndef ESP_8_BIT_HOST_H
+#define ESP_8_BIT_HOST_H
+
+#include "Arduino.h"
+#include <chrono>
+
+extern "C" void video_isr(const volatile void* buf);
+
+extern int _line_width;
+extern int _line_count;
+
+// One DMA line, large enough for the longest (PAL) line
+extern uint16_t host_line[2048];
+
+// Generate lines of video, as many line interrupts would
+static inline void host_lines(int lines)
+{
+  for (int i = 0; i < lines; i++)
+  {
+    video_isr(host_line);
+  }
+}
+
+// Seconds since an arbitrary start, for benchmarks
+static inline double host_seconds()
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+extern int host_failures;
+
+#define CHECK(condition, ...) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #condition); \
+      printf(__VA_ARGS__); \
+      printf("\n"); \
+      host_failures++; \
+    } \
+  } while (0)
+
+// Print result and return exit status for main()
+int host_result(const char* name);
+
+#endif // ESP_8_BIT_HOST_H
@@ -0,0 +1,106 @@
+/*
+
+Stand-in for the Arduino and ESP-IDF declarations used by ESP_8_BIT, so the
+library builds on a desktop host for extras/test. Hardware setup calls do
+nothing, video_isr() is called directly by the tests, and waiting on a task
+notification calls host_wait_hook so a test can generate video lines while
+the library waits for vertical blank.
+
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+using std::min;
+using std::max;
+
+#define ARDUINO_ARCH_ESP32 1
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define PROGMEM
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define ESP_LOGE(tag, ...) host_log(tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) host_log(tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) host_log(tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) host_log(tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) host_log(tag, __VA_ARGS__)
+void host_log(const char* tag, const char* format, ...);
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERROR_CHECK(x) do { if ((x) != ESP_OK) abort(); } while (0)
+
+#define MALLOC_CAP_DMA 1
+#define MALLOC_CAP_8BIT 2
+#define MALLOC_CAP_INTERNAL 4
+#define MALLOC_CAP_32BIT 8
+static inline void* heap_caps_calloc(size_t n, size_t size, uint32_t) { return calloc(n, size); }
+static inline void* heap_caps_malloc(size_t size, uint32_t) { return malloc(size); }
+static inline void heap_caps_free(void* p) { free(p); }
+
+// Cycle counter, advanced by one per read unless a test moves it along
+extern uint32_t host_ccount;
+static inline uint32_t xthal_get_ccount() { return host_ccount++; }
+
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY 0xFFFFFFFF
+extern void (*host_wait_hook)();
+static inline uint32_t ulTaskNotifyTake(BaseType_t, uint32_t) { if (host_wait_hook) host_wait_hook(); return 0; }
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t, void*) {}
+static inline TaskHandle_t xTaskGetCurrentTaskHandle() { return 0; }
+static inline void setCpuFrequencyMhz(int) {}
+
+typedef struct {
+  volatile uint32_t size:12, length:12, offset:5, sosf:1, eof:1, owner:1;
+  volatile uint8_t* buf;
+  uint32_t empty;
+} lldesc_t;
+typedef void* intr_handle_t;
+static inline esp_err_t esp_intr_enable(intr_handle_t) { return ESP_OK; }
+static inline esp_err_t esp_intr_disable(intr_handle_t) { return ESP_OK; }
+struct host_i2s_t {
+  struct { uint32_t out_eof; uint32_t val; } int_st, int_clr;
+  uintptr_t out_eof_des_addr;
+};
+extern host_i2s_t I2S0;
+static inline void dac_i2s_disable() {}
+#define DAC_CHANNEL_1 0
+static inline void dac_output_disable(int) {}
+static inline void rtc_clk_apll_enable(bool, int, int, int, int) {}
+#define PERIPH_I2S0_MODULE 0
+static inline void periph_module_disable(int) {}
+typedef int portMUX_TYPE;
+#define portENTER_CRITICAL(x)
+#define portEXIT_CRITICAL(x)
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define RTC_CNTL_ANA_CONF_REG 0
+#define RTC_CNTL_PLLA_FORCE_PD 0
+#define RTC_CNTL_PLLA_FORCE_PU 0
+#define CLEAR_PERI_REG_MASK(a, b)
+#define SET_PERI_REG_MASK(a, b)
+
+static inline unsigned long millis() { return 0; }
+static inline unsigned long micros() { return 0; }
+static inline void delay(unsigned long) {}
+static inline long random(long a) { return rand() % a; }
+static inline long random(long a, long b) { return a + rand() % (b - a); }
+
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#define pgm_read_dword(addr) (*(const unsigned long *)(addr))
+#define boolean bool
+#define _swap_int16_t(a, b) { int16_t t = a; a = b; b = t; }
+class __FlashStringHelper;
@@ -0,0 +1,100 @@
+/*
+
+Band presentation: presentBand() swaps one band of lines once video
+generation is outside of it, a whole buffer swap while a band is pending
+presents it along with the rest of the back buffer, and ESP_8_BIT_GFX keeps
+drawing into the back buffer with copyAfterSwap honored either way.
+
+*/
+
+#include "host.h"
+
+// Included rather than linked to reach its file scope state
+#include "ESP_8_BIT_composite.cpp"
+#include "ESP_8_BIT_GFX.h"
+
+static int waits;
+static bool swapWhilePending;
+
+// Stands in for the video interrupt while presentBand() waits
+static void wait_hook()
+{
+  waits++;
+  if (swapWhilePending)
+  {
+    // As if another task called presentImmediate() before the band swap
+    _swapImmediate = true;
+    swapWhilePending = false;
+  }
+  host_lines(1);
+}
+
+static void fill_band(uint8_t** lines, int band, int bandLines, uint8_t value)
+{
+  for (int y = band*bandLines; y < (band + 1)*bandLines; y++)
+  {
+    memset(lines[y], value, 256);
+  }
+}
+
+static bool band_is(uint8_t** lines, int band, int bandLines, uint8_t value)
+{
+  for (int y = band*bandLines; y < (band + 1)*bandLines; y++)
+  {
+    for (int x = 0; x < 256; x++)
+    {
+      if (lines[y][x] != value)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  ESP_8_BIT_GFX gfx(true, 8);
+  ESP_8_BIT_composite* video = gfx.getComposite();
+  gfx.begin();
+  gfx.copyAfterSwap = true;
+  host_wait_hook = wait_hook;
+
+  video->setBandCount(5);
+  int bandLines = video->getBandLines();
+  CHECK(bandLines == 48, "%d", bandLines);
+
+  // Beam in band 1, band 1 waits for it to leave, band 3 goes right away
+  host_lines(60);
+  for (int band = 1; band <= 3; band += 2)
+  {
+    fill_band(video->getFrameBufferLines(), band, bandLines, 0x10 + band);
+    waits = 0;
+    gfx.presentBand(band);
+    CHECK(band_is(_lines, band, bandLines, 0x10 + band), "band %d not on screen", band);
+    CHECK(band_is(_backBuffer, band, bandLines, 0x10 + band), "band %d not copied back", band);
+    CHECK(0 == _bandPending, "%x", _bandPending);
+    CHECK(band == 1 ? waits > 1 : waits == 1, "band %d swapped after %d lines", band, waits);
+  }
+
+  // Whole buffer swap while band 2 is pending
+  uint8_t** front = _lines;
+  fill_band(video->getFrameBufferLines(), 2, bandLines, 0x22);
+  swapWhilePending = true;
+  gfx.presentBand(2);
+  CHECK(_lines != front, "no whole buffer swap happened");
+  CHECK(band_is(_lines, 2, bandLines, 0x22), "pending band lost in swap");
+  CHECK(band_is(_backBuffer, 2, bandLines, 0x22), "band not copied to new back buffer");
+  CHECK(_bandScanoutPending & (1 << 2), "band latency not tracked");
+  gfx.drawPixel(0, 2*bandLines, 0x33);
+  CHECK(_backBuffer[2*bandLines][0] == 0x33, "drawing outside back buffer");
+  CHECK(_lines[2*bandLines][0] == 0x22, "drawing into front buffer");
+
+  // Out of range bands change nothing
+  front = _lines;
+  gfx.presentBand(5);
+  gfx.presentBand(-1);
+  CHECK(_lines == front && 0 == _bandPending, "bad band presented");
+
+  return host_result("test_bands");
+}
@@ -0,0 +1,48 @@
+/*
+
+Display lists: a screen made only of display list entries runs without a
+frame buffer, and keeps running when asked to remove its display list.
+
+*/
+
+#include "host.h"
+#include "ESP_8_BIT_composite.h"
+
+static uint32_t pixels[64];
+
+int main()
+{
+  ESP_8_BIT_composite video(true);
+  memset(pixels, 0x1C, sizeof(pixels));
+
+  ESP_8_BIT_display_list_entry list[3] = {};
+  list[0].mode = ESP_8_BIT_DL_SOLID;
+  list[0].lines = 40;
+  list[0].color = 0xE0;
+  list[1].mode = ESP_8_BIT_DL_BITMAP;
+  list[1].lines = 1;
+  list[1].data = (const uint8_t*)pixels;
+  list[2].mode = ESP_8_BIT_DL_REPEAT;
+  list[2].lines = 199;
+  video.setDisplayList(list, 3);
+  video.begin();
+  CHECK(NULL == video.getFrameBufferLines(), "frame buffer allocated");
+
+  host_lines(_line_count);
+  uint32_t frames = video.getRenderedFrameCount();
+  CHECK(frames == 1, "%u", frames);
+
+  // Nothing to go back to, the display list stays
+  video.setDisplayList(NULL, 0);
+  host_lines(2*_line_count);
+  CHECK(video.getRenderedFrameCount() == frames + 2, "video stopped at %u frames",
+    video.getRenderedFrameCount());
+
+  // Replacing it still works
+  list[0].color = 0x03;
+  video.setDisplayList(list, 3);
+  host_lines(_line_count);
+  CHECK(video.getRenderedFrameCount() == frames + 3, "%u", video.getRenderedFrameCount());
+
+  return host_result("test_display_list");
+}
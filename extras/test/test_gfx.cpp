@@ -0,0 +1,918 @@
+/*
+
+ESP_8_BIT_GFX drawing calls against Adafruit_GFX. Each shape, bitmap and
+text call ESP_8_BIT_GFX overrides is drawn by the override, then again over
+the same frame buffer contents by Adafruit_GFX on a stand-in that draws
+through ESP_8_BIT_GFX::drawPixel() only, and the two frame buffers must
+match byte for byte. Calls Adafruit_GFX does not have are drawn pixel by
+pixel on the stand-in as documented. Positions and sizes are random, most
+crossing a screen edge, some thousands of pixels off screen, in all four
+rotations, at color depth 8 and 16 and in 1 and 2 bit monochrome. Zero and
+negative sizes draw nothing, as they did before the overrides.
+
+drawPixel() itself is checked against the rotation and clipping of
+Adafruit_GFX first.
+
+Only one ESP_8_BIT_composite may exist in a program, so each frame buffer
+format is tested in a child process.
+
+*/
+
+#include "host.h"
+#include <math.h>
+#include <algorithm>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ESP_8_BIT_GFX.h"
+
+static uint32_t seed = 11;
+static int rnd(int n)
+{
+  seed = seed*1103515245 + 12345;
+  return (int)((seed >> 8) % n);
+}
+
+static int rnd_range(int lo, int hi)
+{
+  return lo + rnd(hi - lo + 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Reference: Adafruit_GFX drawing through ESP_8_BIT_GFX::drawPixel()
+
+class PixelOnly : public Adafruit_GFX
+{
+  public:
+    PixelOnly(ESP_8_BIT_GFX& target, int16_t w, int16_t h, uint8_t colorDepth)
+      : Adafruit_GFX(w, h), _target(target), _colorDepth(colorDepth)
+    {
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override
+    {
+      _target.drawPixel(x, y, color);
+    }
+
+    // Before the overrides, fast lines went to ESP_8_BIT_GFX::fillRect(),
+    // which drew nothing for a length below 1 where Adafruit_GFX draws a
+    // line back past the start. Rounded rectangles reach that with a
+    // radius of half their size.
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override
+    {
+      for (int i = 0; i < w; i++)
+      {
+        drawPixel(x + i, y, color);
+      }
+    }
+
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override
+    {
+      for (int i = 0; i < h; i++)
+      {
+        drawPixel(x, y + i, color);
+      }
+    }
+
+    void drawRGB332Bitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+      int16_t w, int16_t h)
+    {
+      for (int j = 0; j < h; j++)
+      {
+        for (int i = 0; i < w; i++)
+        {
+          drawPixel(x + i, y + j, color332(bitmap[j*w + i]));
+        }
+      }
+    }
+
+    void drawSprite(int16_t x, int16_t y, const uint8_t sheet[],
+      int16_t sheetWidth, int16_t sx, int16_t sy, int16_t w, int16_t h,
+      int16_t colorKey, uint8_t flip)
+    {
+      for (int j = 0; j < h; j++)
+      {
+        int row = sy + (flip & ESP_8_BIT_GFX::SPRITE_FLIP_Y ? h - 1 - j : j);
+        for (int i = 0; i < w; i++)
+        {
+          uint8_t p = sheet[row*sheetWidth + sx + (flip & ESP_8_BIT_GFX::SPRITE_FLIP_X ? w - 1 - i : i)];
+          if (p != colorKey)
+          {
+            drawPixel(x + i, y + j, color332(p));
+          }
+        }
+      }
+    }
+
+    // Even-odd rule, each row filled from the first pixel center at or
+    // right of one crossing up to the one of the next
+    void fillPolygon(const int16_t* points, uint16_t count, uint16_t color)
+    {
+      if (count > ESP_8_BIT_GFX::MAX_POLYGON_POINTS)
+      {
+        return;
+      }
+      for (int y = 0; y < _height; y++)
+      {
+        int crossings[ESP_8_BIT_GFX::MAX_POLYGON_POINTS];
+        int n = 0;
+        for (int i = 0; i < count; i++)
+        {
+          int j = (i + 1) % count;
+          int64_t x0 = points[2*i], y0 = points[2*i + 1];
+          int64_t x1 = points[2*j], y1 = points[2*j + 1];
+          if (y0 > y1)
+          {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+          }
+          if (y < y0 || y >= y1)
+          {
+            continue;
+          }
+          // Ceiling of x0 + (y - y0)*(x1 - x0)/(y1 - y0)
+          int64_t num = x0*(y1 - y0) + (y - y0)*(x1 - x0);
+          int64_t den = y1 - y0;
+          int64_t c = num/den;
+          if (c*den < num)
+          {
+            c++;
+          }
+          crossings[n++] = (int)c;
+        }
+        std::sort(crossings, crossings + n);
+        for (int i = 0; i + 1 < n; i += 2)
+        {
+          for (int x = std::max(crossings[i], 0); x < std::min(crossings[i + 1], (int)_width); x++)
+          {
+            drawPixel(x, y, color);
+          }
+        }
+      }
+    }
+
+    // Rotation by a multiple of 90 degrees and whole number scales, where
+    // fixed point steps are exact for images of even size
+    void drawRotatedBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+      int16_t w, int16_t h, float degrees, float scale, int16_t colorKey)
+    {
+      if (w < 1 || h < 1)
+      {
+        return;
+      }
+      int reach = (w + h)*(int)scale/2 + 2;
+      for (int sy = std::max(y - reach, 0); sy < std::min(y + reach, (int)_height); sy++)
+      {
+        for (int sx = std::max(x - reach, 0); sx < std::min(x + reach, (int)_width); sx++)
+        {
+          int u, v;
+          image_point(sx, sy, x, y, w, h, degrees, scale, u, v);
+          if (u >= 0 && u < w && v >= 0 && v < h && bitmap[v*w + u] != colorKey)
+          {
+            drawPixel(sx, sy, color332(bitmap[v*w + u]));
+          }
+        }
+      }
+    }
+
+    void fillRectRotatedBitmap(int16_t x, int16_t y, int16_t w, int16_t h,
+      const uint8_t bitmap[], int16_t bw, int16_t bh, int16_t cx, int16_t cy,
+      float degrees, float scale, int16_t colorKey)
+    {
+      for (int sy = std::max((int)y, 0); sy < std::min(y + h, (int)_height); sy++)
+      {
+        for (int sx = std::max((int)x, 0); sx < std::min(x + w, (int)_width); sx++)
+        {
+          int u, v;
+          image_point(sx, sy, cx, cy, bw, bh, degrees, scale, u, v);
+          uint8_t p = bitmap[(v & (bh - 1))*bw + (u & (bw - 1))];
+          if (p != colorKey)
+          {
+            drawPixel(sx, sy, color332(p));
+          }
+        }
+      }
+    }
+
+  private:
+    // Color drawing the given RGB332 value in the target color depth
+    uint16_t color332(uint8_t c)
+    {
+      return 8 == _colorDepth ? c : (c & 0xE0) << 8 | (c & 0x1C) << 6 | (c & 0x03) << 3;
+    }
+
+    // Image pixel under the center of screen pixel (sx, sy), with image
+    // center (w/2, h/2) on screen point (cx, cy)
+    static void image_point(int sx, int sy, int cx, int cy, int w, int h,
+      float degrees, float scale, int& u, int& v)
+    {
+      int turn = (((int)degrees/90) % 4 + 4) % 4;
+      int cosine = (0 == turn) - (2 == turn);
+      int sine = (1 == turn) - (3 == turn);
+      double dx = sx + 0.5 - cx;
+      double dy = sy + 0.5 - cy;
+      u = (int)floor(w/2.0 + (cosine*dx + sine*dy)/scale);
+      v = (int)floor(h/2.0 + (cosine*dy - sine*dx)/scale);
+    }
+
+    ESP_8_BIT_GFX& _target;
+    uint8_t _colorDepth;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Drawing calls
+
+enum
+{
+  FAST_HLINE, FAST_VLINE, FILL_RECT, FILL_SCREEN, LINE, RECT,
+  WRITE_PIXEL, WRITE_HLINE, WRITE_VLINE, WRITE_FILL_RECT, WRITE_LINE,
+  CIRCLE, FILL_CIRCLE, CIRCLE_HELPER, FILL_CIRCLE_HELPER,
+  TRIANGLE, FILL_TRIANGLE, ROUND_RECT, FILL_ROUND_RECT,
+  BITMAP, BITMAP_BG, GRAY_BITMAP, GRAY_BITMAP_MASK, RGB_BITMAP,
+  RGB_BITMAP_MASK, CHAR, TEXT, FONT_CHAR, FONT_TEXT,
+  RGB332_BITMAP, SPRITE, POLYGON, ROTATED_BITMAP, FILL_RECT_ROTATED_BITMAP,
+  CALLS
+};
+
+static const char* call_names[CALLS] = {
+  "drawFastHLine", "drawFastVLine", "fillRect", "fillScreen", "drawLine", "drawRect",
+  "writePixel", "writeFastHLine", "writeFastVLine", "writeFillRect", "writeLine",
+  "drawCircle", "fillCircle", "drawCircleHelper", "fillCircleHelper",
+  "drawTriangle", "fillTriangle", "drawRoundRect", "fillRoundRect",
+  "drawBitmap", "drawBitmap with background", "drawGrayscaleBitmap",
+  "drawGrayscaleBitmap with mask", "drawRGBBitmap",
+  "drawRGBBitmap with mask", "drawChar", "print", "drawChar in GFXfont",
+  "print in GFXfont", "drawRGB332Bitmap", "drawSprite", "fillPolygon",
+  "drawRotatedBitmap", "fillRectRotatedBitmap"
+};
+
+struct call_args
+{
+  int16_t x, y, w, h;
+  int16_t x1, y1, x2, y2;
+  int16_t r;
+  uint16_t color, bg;
+  uint8_t sizeX, sizeY;
+  bool constData;
+  bool wrap;
+  bool cp437;
+  char text[48];
+  int16_t sheetWidth, sx, sy;
+  int16_t colorKey;
+  uint8_t flip;
+  int16_t points[2*(ESP_8_BIT_GFX::MAX_POLYGON_POINTS + 1)];
+  uint16_t count;
+  float degrees, scale;
+};
+
+// Source data of every bitmap call: RGB332 pixels with one color in four
+// being colorKey, 16-bit pixels, and bits
+static const int DATA_SIZE = 300;
+static const uint8_t COLOR_KEY = 0xE3;
+static uint8_t data8[DATA_SIZE*DATA_SIZE];
+static uint16_t data16[DATA_SIZE*DATA_SIZE];
+static uint8_t bits[DATA_SIZE*DATA_SIZE/8];
+static uint8_t maskBits[DATA_SIZE*DATA_SIZE/8];
+static uint8_t keyed[64*64];
+
+// Random GFXfont with glyphs of every size up to 12 by 14 pixels, empty
+// ones included, reaching left of and below the cursor
+static uint8_t fontBitmap[4096];
+static GFXglyph fontGlyphs[95];
+static GFXfont font = { fontBitmap, fontGlyphs, 32, 126, 18 };
+
+static void make_data()
+{
+  for (int i = 0; i < DATA_SIZE*DATA_SIZE; i++)
+  {
+    data8[i] = rnd(4) ? rnd(256) : COLOR_KEY;
+    data16[i] = rnd(1 << 16);
+  }
+  for (int i = 0; i < DATA_SIZE*DATA_SIZE/8; i++)
+  {
+    bits[i] = rnd(256);
+    maskBits[i] = rnd(256);
+  }
+  memset(keyed, COLOR_KEY, sizeof(keyed));
+
+  int offset = 0;
+  for (int i = 0; i < 95; i++)
+  {
+    GFXglyph& glyph = fontGlyphs[i];
+    glyph.bitmapOffset = offset;
+    glyph.width = rnd(13);
+    glyph.height = rnd(15);
+    glyph.xAdvance = rnd(15);
+    glyph.xOffset = rnd_range(-3, 3);
+    glyph.yOffset = rnd_range(-14, 2);
+    int bytes = (glyph.width*glyph.height + 7)/8;
+    for (int k = 0; k < bytes; k++)
+    {
+      fontBitmap[offset + k] = rnd(256);
+    }
+    offset += bytes;
+  }
+}
+
+// Screen coordinate: mostly within half a screen of it, some right at an
+// edge, some far off screen
+static int16_t coord(int limit)
+{
+  switch (rnd(8))
+  {
+    case 0:
+      return rnd_range(-3, 3);
+    case 1:
+      return limit + rnd_range(-4, 2);
+    case 2:
+      return (rnd(2) ? 1 : -1)*rnd_range(8000, 16000);
+    default:
+      return rnd_range(-limit/2, limit + limit/2);
+  }
+}
+
+// Size: mostly up to a screen, some a few pixels, some past the screen
+static int16_t size(int limit)
+{
+  switch (rnd(4))
+  {
+    case 0:
+      return rnd_range(1, 4);
+    case 1:
+      return rnd_range(limit, limit + limit/2);
+    default:
+      return rnd_range(1, limit);
+  }
+}
+
+static void make_args(int call, int width, int height, call_args& a)
+{
+  memset(&a, 0, sizeof(a));
+  a.x = coord(width);
+  a.y = coord(height);
+  a.w = size(width);
+  a.h = size(height);
+  a.color = rnd(1 << 16);
+  a.bg = rnd(2) ? a.color : rnd(1 << 16);
+  a.constData = rnd(2);
+
+  switch (call)
+  {
+    case LINE:
+    case WRITE_LINE:
+      a.x1 = coord(width);
+      a.y1 = coord(height);
+      break;
+    case CIRCLE:
+    case FILL_CIRCLE:
+    case CIRCLE_HELPER:
+    case FILL_CIRCLE_HELPER:
+    case ROUND_RECT:
+    case FILL_ROUND_RECT:
+      a.r = rnd(3) ? rnd(24) : rnd(400);
+      a.flip = rnd(16);
+      break;
+    case TRIANGLE:
+    case FILL_TRIANGLE:
+      // Vertices near the first, which may be far off screen
+      a.x1 = a.x + rnd_range(-300, 300);
+      a.y1 = a.y + rnd_range(-300, 300);
+      a.x2 = a.x + rnd_range(-300, 300);
+      a.y2 = rnd(8) ? a.y + rnd_range(-300, 300) : a.y;
+      break;
+    case BITMAP:
+    case BITMAP_BG:
+    case GRAY_BITMAP:
+    case GRAY_BITMAP_MASK:
+    case RGB_BITMAP:
+    case RGB_BITMAP_MASK:
+    case RGB332_BITMAP:
+      a.w = size(DATA_SIZE*2/3);
+      a.h = size(DATA_SIZE*2/3);
+      break;
+    case CHAR:
+    case FONT_CHAR:
+    case TEXT:
+    case FONT_TEXT:
+      a.sizeX = rnd_range(1, 4);
+      a.sizeY = rnd(2) ? a.sizeX : rnd_range(1, 4);
+      a.wrap = rnd(2);
+      a.cp437 = rnd(2);
+      a.r = FONT_CHAR == call ? rnd_range(32, 126) : rnd(256);
+      for (int i = 0, n = rnd_range(1, sizeof(a.text) - 1); i < n; i++)
+      {
+        int c = rnd(16) ? rnd_range(1, 255) : (rnd(2) ? '\n' : '\r');
+        a.text[i] = (char)c;
+      }
+      break;
+    case SPRITE:
+      a.sheetWidth = rnd_range(1, DATA_SIZE);
+      a.sx = rnd(a.sheetWidth);
+      a.sy = rnd(DATA_SIZE);
+      a.w = rnd_range(1, a.sheetWidth - a.sx);
+      a.h = rnd_range(1, DATA_SIZE - a.sy);
+      a.colorKey = rnd(2) ? COLOR_KEY : -1;
+      a.flip = rnd(4);
+      break;
+    case POLYGON:
+      a.count = rnd(6) ? rnd_range(3, ESP_8_BIT_GFX::MAX_POLYGON_POINTS) : rnd(3);
+      for (int i = 0; i < a.count; i++)
+      {
+        a.points[2*i] = a.x + rnd_range(-300, 300);
+        a.points[2*i + 1] = a.y + rnd_range(-300, 300);
+      }
+      break;
+    case ROTATED_BITMAP:
+      a.w = 2*rnd_range(1, 32);
+      a.h = 2*rnd_range(1, 32);
+      a.degrees = 90*rnd_range(-4, 4);
+      a.scale = 1 << rnd(3);
+      a.colorKey = rnd(2) ? COLOR_KEY : -1;
+      break;
+    case FILL_RECT_ROTATED_BITMAP:
+      a.sheetWidth = 1 << rnd(7);
+      a.r = 1 << rnd(7);
+      a.x1 = coord(width);
+      a.y1 = coord(height);
+      a.degrees = 90*rnd_range(-4, 4);
+      a.scale = 1 << rnd(3);
+      a.colorKey = rnd(2) ? COLOR_KEY : -1;
+      break;
+  }
+}
+
+// Text state in full for each call, text calls leave the cursor behind
+template<class G>
+static void set_text(G& g, const call_args& a, bool custom)
+{
+  g.setFont(custom ? &font : NULL);
+  g.setTextSize(a.sizeX, a.sizeY);
+  if (a.color == a.bg)
+  {
+    g.setTextColor(a.color);
+  }
+  else
+  {
+    g.setTextColor(a.color, a.bg);
+  }
+  g.setTextWrap(a.wrap);
+  g.cp437(a.cp437);
+  g.setCursor(a.x, a.y);
+}
+
+template<class G>
+static void draw(G& g, int call, const call_args& a)
+{
+  switch (call)
+  {
+    case FAST_HLINE:
+      g.drawFastHLine(a.x, a.y, a.w, a.color);
+      break;
+    case FAST_VLINE:
+      g.drawFastVLine(a.x, a.y, a.h, a.color);
+      break;
+    case FILL_RECT:
+      g.fillRect(a.x, a.y, a.w, a.h, a.color);
+      break;
+    case FILL_SCREEN:
+      g.fillScreen(a.color);
+      break;
+    case LINE:
+      g.drawLine(a.x, a.y, a.x1, a.y1, a.color);
+      break;
+    case RECT:
+      g.drawRect(a.x, a.y, a.w, a.h, a.color);
+      break;
+    case WRITE_PIXEL:
+      g.startWrite();
+      g.writePixel(a.x, a.y, a.color);
+      g.endWrite();
+      break;
+    case WRITE_HLINE:
+      g.startWrite();
+      g.writeFastHLine(a.x, a.y, a.w, a.color);
+      g.endWrite();
+      break;
+    case WRITE_VLINE:
+      g.startWrite();
+      g.writeFastVLine(a.x, a.y, a.h, a.color);
+      g.endWrite();
+      break;
+    case WRITE_FILL_RECT:
+      g.startWrite();
+      g.writeFillRect(a.x, a.y, a.w, a.h, a.color);
+      g.endWrite();
+      break;
+    case WRITE_LINE:
+      g.startWrite();
+      g.writeLine(a.x, a.y, a.x1, a.y1, a.color);
+      g.endWrite();
+      break;
+    case CIRCLE:
+      g.drawCircle(a.x, a.y, a.r, a.color);
+      break;
+    case FILL_CIRCLE:
+      g.fillCircle(a.x, a.y, a.r, a.color);
+      break;
+    case CIRCLE_HELPER:
+      g.drawCircleHelper(a.x, a.y, a.r, a.flip, a.color);
+      break;
+    case FILL_CIRCLE_HELPER:
+      g.fillCircleHelper(a.x, a.y, a.r, a.flip & 3, a.h & 63, a.color);
+      break;
+    case TRIANGLE:
+      g.drawTriangle(a.x, a.y, a.x1, a.y1, a.x2, a.y2, a.color);
+      break;
+    case FILL_TRIANGLE:
+      g.fillTriangle(a.x, a.y, a.x1, a.y1, a.x2, a.y2, a.color);
+      break;
+    case ROUND_RECT:
+      g.drawRoundRect(a.x, a.y, a.w, a.h, a.r, a.color);
+      break;
+    case FILL_ROUND_RECT:
+      g.fillRoundRect(a.x, a.y, a.w, a.h, a.r, a.color);
+      break;
+    case BITMAP:
+      if (a.constData)
+      {
+        g.drawBitmap(a.x, a.y, (const uint8_t*)bits, a.w, a.h, a.color);
+      }
+      else
+      {
+        g.drawBitmap(a.x, a.y, bits, a.w, a.h, a.color);
+      }
+      break;
+    case BITMAP_BG:
+      if (a.constData)
+      {
+        g.drawBitmap(a.x, a.y, (const uint8_t*)bits, a.w, a.h, a.color, a.bg);
+      }
+      else
+      {
+        g.drawBitmap(a.x, a.y, bits, a.w, a.h, a.color, a.bg);
+      }
+      break;
+    case GRAY_BITMAP:
+      if (a.constData)
+      {
+        g.drawGrayscaleBitmap(a.x, a.y, (const uint8_t*)data8, a.w, a.h);
+      }
+      else
+      {
+        g.drawGrayscaleBitmap(a.x, a.y, data8, a.w, a.h);
+      }
+      break;
+    case GRAY_BITMAP_MASK:
+      if (a.constData)
+      {
+        g.drawGrayscaleBitmap(a.x, a.y, (const uint8_t*)data8,
+          (const uint8_t*)maskBits, a.w, a.h);
+      }
+      else
+      {
+        g.drawGrayscaleBitmap(a.x, a.y, data8, maskBits, a.w, a.h);
+      }
+      break;
+    case RGB_BITMAP:
+      if (a.constData)
+      {
+        g.drawRGBBitmap(a.x, a.y, (const uint16_t*)data16, a.w, a.h);
+      }
+      else
+      {
+        g.drawRGBBitmap(a.x, a.y, data16, a.w, a.h);
+      }
+      break;
+    case RGB_BITMAP_MASK:
+      if (a.constData)
+      {
+        g.drawRGBBitmap(a.x, a.y, (const uint16_t*)data16,
+          (const uint8_t*)maskBits, a.w, a.h);
+      }
+      else
+      {
+        g.drawRGBBitmap(a.x, a.y, data16, maskBits, a.w, a.h);
+      }
+      break;
+    case CHAR:
+    case FONT_CHAR:
+      set_text(g, a, FONT_CHAR == call);
+      if (a.sizeX == a.sizeY)
+      {
+        g.drawChar(a.x, a.y, a.r, a.color, a.bg, a.sizeX);
+      }
+      else
+      {
+        g.drawChar(a.x, a.y, a.r, a.color, a.bg, a.sizeX, a.sizeY);
+      }
+      break;
+    case TEXT:
+    case FONT_TEXT:
+      set_text(g, a, FONT_TEXT == call);
+      g.print(a.text);
+      break;
+    case RGB332_BITMAP:
+      g.drawRGB332Bitmap(a.x, a.y, data8, a.w, a.h);
+      break;
+    case SPRITE:
+      g.drawSprite(a.x, a.y, data8, a.sheetWidth, a.sx, a.sy, a.w, a.h,
+        a.colorKey, a.flip);
+      break;
+    case POLYGON:
+      g.fillPolygon(a.points, a.count, a.color);
+      break;
+    case ROTATED_BITMAP:
+      g.drawRotatedBitmap(a.x, a.y, data8, a.w, a.h, a.degrees, a.scale, a.colorKey);
+      break;
+    case FILL_RECT_ROTATED_BITMAP:
+      g.fillRectRotatedBitmap(a.x, a.y, a.w, a.h, data8, a.sheetWidth, a.r,
+        a.x1, a.y1, a.degrees, a.scale, a.colorKey);
+      break;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Frame buffer formats
+
+struct frame_format
+{
+  const char* name;
+  uint8_t colorDepth;
+  int monochromeWidth;
+  int bitsPerPixel;
+};
+
+static const frame_format formats[] = {
+  { "8-bit color", 8, 0, 8 },
+  { "16-bit color", 16, 0, 8 },
+  { "1-bit monochrome", 16, 512, 1 },
+  { "2-bit monochrome", 8, 384, 2 }
+};
+
+static const frame_format* format;
+static ESP_8_BIT_GFX* gfx;
+static PixelOnly* ref;
+static int frameWidth;
+static int frameHeight;
+static int lineBytes;
+
+static const int MAX_FRAME = 256*240;
+static uint8_t noise[MAX_FRAME];
+static uint8_t drawn[MAX_FRAME];
+static uint8_t expected[MAX_FRAME];
+static const uint8_t cleared[MAX_FRAME] = { 0 };
+
+static void write_frame(const uint8_t* src)
+{
+  uint8_t** lines = gfx->getComposite()->getFrameBufferLines();
+  for (int y = 0; y < frameHeight; y++)
+  {
+    memcpy(lines[y], src + y*lineBytes, lineBytes);
+  }
+}
+
+static void read_frame(uint8_t* dst)
+{
+  uint8_t** lines = gfx->getComposite()->getFrameBufferLines();
+  for (int y = 0; y < frameHeight; y++)
+  {
+    memcpy(dst + y*lineBytes, lines[y], lineBytes);
+  }
+}
+
+static int first_difference(const uint8_t* a, const uint8_t* b)
+{
+  if (0 == memcmp(a, b, lineBytes*frameHeight))
+  {
+    return -1;
+  }
+  for (int i = 0; i < lineBytes*frameHeight; i++)
+  {
+    if (a[i] != b[i])
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Checks
+
+// Give up on a format after this many failures
+static const int MAX_FAILURES = 20;
+
+// Adafruit_GFX rotation and clipping, one pixel at a time on a cleared
+// frame buffer. Monochrome pixels are drawn white to find their bits.
+static void check_pixels(int rotation)
+{
+  for (int n = 0; n < 500 && host_failures < MAX_FAILURES; n++)
+  {
+    int16_t x = coord(gfx->width());
+    int16_t y = coord(gfx->height());
+    uint16_t color = 8 == format->bitsPerPixel ? rnd(1 << 16) : 0xFFFF;
+    write_frame(cleared);
+    gfx->drawPixel(x, y, color);
+    read_frame(drawn);
+
+    int fx = x;
+    int fy = y;
+    switch (rotation) {
+    case 1:
+      fx = frameWidth - 1 - y;
+      fy = x;
+      break;
+    case 2:
+      fx = frameWidth - 1 - x;
+      fy = frameHeight - 1 - y;
+      break;
+    case 3:
+      fx = y;
+      fy = frameHeight - 1 - x;
+      break;
+    }
+    if (fx >= 0 && fx < frameWidth && fy >= 0 && fy < frameHeight)
+    {
+      int bpp = format->bitsPerPixel;
+      int i = fy*lineBytes + fx*bpp/8;
+      uint8_t value = ((1 << bpp) - 1) << (8 - bpp - fx*bpp % 8);
+      if (8 == bpp)
+      {
+        value = 8 == format->colorDepth ? (uint8_t)color :
+          (color >> 13) << 5 | ((color >> 8) & 7) << 2 | ((color >> 3) & 3);
+      }
+      CHECK(drawn[i] == value, "%s rotation %d: drawPixel(%d, %d, %04X) put %02X, not %02X",
+        format->name, rotation, x, y, color, drawn[i], value);
+      drawn[i] = 0;
+    }
+    int i = first_difference(drawn, cleared);
+    CHECK(i < 0, "%s rotation %d: drawPixel(%d, %d) wrote line %d byte %d",
+      format->name, rotation, x, y, i/lineBytes, i%lineBytes);
+  }
+}
+
+// Same frame buffer from the override and from Adafruit_GFX, drawn over
+// the same noise
+static void check_call(int rotation, int call, const call_args& a)
+{
+  write_frame(noise);
+  draw(*gfx, call, a);
+  read_frame(drawn);
+  write_frame(noise);
+  draw(*ref, call, a);
+  read_frame(expected);
+
+  int i = first_difference(drawn, expected);
+  CHECK(i < 0, "%s rotation %d: %s x %d y %d w %d h %d x1 %d y1 %d x2 %d y2 %d r %d "
+    "color %04X bg %04X size %dx%d degrees %g scale %g: line %d byte %d is %02X, "
+    "Adafruit_GFX %02X", format->name, rotation, call_names[call], a.x, a.y, a.w, a.h,
+    a.x1, a.y1, a.x2, a.y2, a.r, a.color, a.bg, a.sizeX, a.sizeY, a.degrees, a.scale,
+    i/lineBytes, i%lineBytes,
+    drawn[i], expected[i]);
+}
+
+// Every call over random areas, with the glyph cache on, off and too
+// small for the text. fillScreen() has nothing random but its color.
+static void check_calls(int rotation)
+{
+  static const size_t cacheSizes[] = { 8192, 0, 100 };
+  for (int n = 0; n < 16 && host_failures < MAX_FAILURES; n++)
+  {
+    gfx->setGlyphCacheSize(cacheSizes[n % 3]);
+    for (int call = 0; call < CALLS && host_failures < MAX_FAILURES; call++)
+    {
+      if (FILL_SCREEN == call && n >= 2)
+      {
+        continue;
+      }
+      call_args a;
+      make_args(call, gfx->width(), gfx->height(), a);
+      check_call(rotation, call, a);
+    }
+  }
+}
+
+// Zero and negative sizes leave the frame buffer alone
+static void check_empty(int rotation)
+{
+  static const int16_t sizes[] = { 0, -1, -7, -300, INT16_MIN };
+  for (int n = 0; n < 40 && host_failures < MAX_FAILURES; n++)
+  {
+    int16_t x = rnd_range(-20, gfx->width() + 20);
+    int16_t y = rnd_range(-20, gfx->height() + 20);
+    int16_t empty = sizes[n % 5];
+    int16_t w = n & 1 ? empty : rnd_range(1, 100);
+    int16_t h = n & 1 ? rnd_range(1, 100) : empty;
+    int16_t r = rnd(20);
+    int16_t points[2*(ESP_8_BIT_GFX::MAX_POLYGON_POINTS + 1)];
+    for (int i = 0; i < ESP_8_BIT_GFX::MAX_POLYGON_POINTS + 1; i++)
+    {
+      points[2*i] = x + rnd_range(-50, 50);
+      points[2*i + 1] = y + rnd_range(-50, 50);
+    }
+
+    write_frame(noise);
+    gfx->drawFastHLine(x, y, empty, 0x1C);
+    gfx->drawFastVLine(x, y, empty, 0x1C);
+    gfx->fillRect(x, y, w, h, 0x1C);
+    gfx->startWrite();
+    gfx->writeFastHLine(x, y, empty, 0x1C);
+    gfx->writeFastVLine(x, y, empty, 0x1C);
+    gfx->writeFillRect(x, y, w, h, 0x1C);
+    gfx->endWrite();
+    gfx->fillRoundRect(x, y, w, h, r, 0x1C);
+    gfx->fillCircle(x, y, -rnd_range(1, 300), 0x1C);
+    gfx->drawBitmap(x, y, (const uint8_t*)bits, w, h, 0x1C);
+    gfx->drawBitmap(x, y, (const uint8_t*)bits, w, h, 0x1C, 0xE0);
+    gfx->drawGrayscaleBitmap(x, y, (const uint8_t*)data8, w, h);
+    gfx->drawGrayscaleBitmap(x, y, (const uint8_t*)data8, (const uint8_t*)maskBits, w, h);
+    gfx->drawRGBBitmap(x, y, (const uint16_t*)data16, w, h);
+    gfx->drawRGBBitmap(x, y, (const uint16_t*)data16, (const uint8_t*)maskBits, w, h);
+    gfx->drawRGB332Bitmap(x, y, data8, w, h);
+    gfx->drawSprite(x, y, data8, DATA_SIZE, 0, 0, w, h);
+    gfx->drawRotatedBitmap(x, y, data8, w, h, rnd(360), 1);
+    gfx->drawRotatedBitmap(x, y, data8, 16, 16, rnd(360), 0);
+    gfx->fillRectRotatedBitmap(x, y, w, h, data8, 16, 16, x, y, rnd(360), 1);
+    gfx->fillRectRotatedBitmap(x, y, 50, 50, data8, 12, 16, x, y, rnd(360), 1);
+    gfx->fillPolygon(points, n % 3, 0x1C);
+    gfx->fillPolygon(points, ESP_8_BIT_GFX::MAX_POLYGON_POINTS + 1, 0x1C);
+    gfx->setFont(n & 2 ? &font : NULL);
+    gfx->drawChar(x, y, 'A' + n, 0x1C, 0xE0, 0);
+    gfx->drawChar(x, y, 'A' + n, 0x1C, 0xE0, 0, 2);
+    gfx->setFont(NULL);
+    read_frame(drawn);
+
+    int i = first_difference(drawn, noise);
+    CHECK(i < 0, "%s rotation %d: size %d at (%d, %d) drew line %d byte %d",
+      format->name, rotation, empty, x, y, i/lineBytes, i%lineBytes);
+  }
+
+  // Every pixel of an image of colorKey is transparent, at any angle
+  for (int n = 0; n < 40 && host_failures < MAX_FAILURES; n++)
+  {
+    write_frame(noise);
+    gfx->drawRotatedBitmap(coord(gfx->width()), coord(gfx->height()), keyed,
+      64, 64, rnd(3600)/10.0f, rnd_range(1, 400)/100.0f, COLOR_KEY);
+    gfx->fillRectRotatedBitmap(coord(gfx->width()), coord(gfx->height()),
+      size(gfx->width()), size(gfx->height()), keyed, 64, 64,
+      coord(gfx->width()), coord(gfx->height()), rnd(3600)/10.0f,
+      rnd_range(1, 400)/100.0f, COLOR_KEY);
+    read_frame(drawn);
+    CHECK(first_difference(drawn, noise) < 0, "%s rotation %d: color key drawn",
+      format->name, rotation);
+  }
+}
+
+static void check_format(const frame_format& f)
+{
+  format = &f;
+  gfx = new ESP_8_BIT_GFX(true, f.colorDepth);
+  if (f.monochromeWidth)
+  {
+    gfx->getComposite()->setMonochrome(f.monochromeWidth, f.bitsPerPixel);
+  }
+  gfx->begin();
+  frameWidth = gfx->getComposite()->getWidth();
+  frameHeight = gfx->getComposite()->getHeight();
+  lineBytes = frameWidth*f.bitsPerPixel/8;
+  ref = new PixelOnly(*gfx, frameWidth, frameHeight, f.colorDepth);
+  CHECK(gfx->getComposite()->getBitsPerPixel() == f.bitsPerPixel, "%s: %d bits per pixel",
+    f.name, gfx->getComposite()->getBitsPerPixel());
+
+  make_data();
+  for (int i = 0; i < MAX_FRAME; i++)
+  {
+    noise[i] = rnd(256);
+  }
+
+  for (int rotation = 0; rotation < 4; rotation++)
+  {
+    gfx->setRotation(rotation);
+    ref->setRotation(rotation);
+    check_pixels(rotation);
+    check_calls(rotation);
+    check_empty(rotation);
+  }
+}
+
+int main()
+{
+  for (const frame_format& f : formats)
+  {
+    fflush(stdout);
+    pid_t child = fork();
+    if (0 == child)
+    {
+      check_format(f);
+      fflush(stdout);
+      _exit(host_failures ? 1 : 0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && 0 == WEXITSTATUS(status), "%s failed", f.name);
+  }
+  return host_result("test_gfx");
+}
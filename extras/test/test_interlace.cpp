@@ -0,0 +1,43 @@
+/*
+
+Interlaced video with a field callback: the callback draws every odd frame
+line, at every frame buffer width, into a line it may fill completely.
+
+*/
+
+#include "host.h"
+#include "ESP_8_BIT_composite.h"
+
+static int width;
+static int calls;
+static int lastLine;
+
+static void IRAM_ATTR odd_line(int line, uint8_t* pixels, void* arg)
+{
+  memset(pixels, 0x1C, width);
+  CHECK(line & 1, "even line %d", line);
+  CHECK(line > lastLine, "line %d after %d", line, lastLine);
+  lastLine = line;
+  calls++;
+}
+
+int main()
+{
+  // Widest frame buffer, one instance per program
+  ESP_8_BIT_composite& video = *new ESP_8_BIT_composite(true);
+  video.setResolution(384, 240);
+  video.setInterlace(true, odd_line);
+  video.begin();
+  width = video.getWidth();
+  CHECK(width == 384, "%d", width);
+
+  for (int frame = 0; frame < 2; frame++)
+  {
+    calls = 0;
+    lastLine = -1;
+    host_lines(_line_count);
+    CHECK(calls == video.getHeight(), "%d odd lines drawn", calls);
+  }
+
+  return host_result("test_interlace");
+}
@@ -0,0 +1,60 @@
+/*
+
+Palette transforms at 3 samples per color clock: luminance comes from the
+three real samples of each entry, the fourth byte keeps repeating the first,
+and a transform set before switching sample rate is rebuilt from the 3
+sample palette. Several changes in one frame never write into the table on
+screen or the one already staged for vertical blank.
+
+*/
+
+#include "host.h"
+
+// Included rather than linked to reach the active palette
+#include "ESP_8_BIT_composite.cpp"
+
+int main()
+{
+  // Kept for the life of the program, as ESP_8_BIT_GFX keeps its own
+  ESP_8_BIT_composite& video = *new ESP_8_BIT_composite(true);
+  video.setGrayscale(true);
+  video.setSamplesPerColorClock(3);
+  video.begin();
+
+  // Staged palette applies at vertical blank
+  host_lines(_line_count);
+  CHECK(_palette != ntsc3_RGB332.entry && _palette != ntsc_RGB332, "no transform active");
+
+  for (int i = 0; i < 256; i++)
+  {
+    uint32_t base = ntsc3_RGB332.entry[i];
+    uint32_t entry = _palette[i];
+    int luma = ((base & 0xFF) + ((base >> 8) & 0xFF) + ((base >> 16) & 0xFF) + 1) / 3;
+    CHECK(entry == luma*0x01010101u, "entry %d is %08X, base %08X", i, entry, base);
+  }
+
+  // Back to the stock 3 sample palette
+  video.setGrayscale(false);
+  host_lines(_line_count);
+  CHECK(_palette == ntsc3_RGB332.entry, "stock palette not restored");
+
+  // Brightness and tint in the same frame, with a transform on screen
+  video.setInvert(true);
+  host_lines(_line_count);
+  const uint32_t* shown = _palette;
+  static uint32_t shownCopy[256];
+  memcpy(shownCopy, shown, sizeof(shownCopy));
+  video.setBrightness(128);
+  const uint32_t* staged = _paletteNext;
+  static uint32_t stagedCopy[256];
+  memcpy(stagedCopy, staged, sizeof(stagedCopy));
+  video.setTint(0xE0, 128);
+  CHECK(_paletteNext != shown && _paletteNext != staged, "rebuilt a table in use");
+  CHECK(0 == memcmp(shown, shownCopy, sizeof(shownCopy)), "table on screen changed");
+  CHECK(0 == memcmp(staged, stagedCopy, sizeof(stagedCopy)), "staged table changed");
+  const uint32_t* last = _paletteNext;
+  host_lines(_line_count);
+  CHECK(_palette == last && !_paletteReady, "last change not applied");
+
+  return host_result("test_palette_transform");
+}
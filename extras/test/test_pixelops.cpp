@@ -0,0 +1,153 @@
+/*
+
+RGB332 pixel operations: the word at a time versions must give the same
+result as per channel math on each pixel, for every pair of pixels in every
+byte of a word, and for rows of any alignment and length.
+
+*/
+
+#include "host.h"
+#include "ESP_8_BIT_pixelops.h"
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  One pixel at a time
+
+static int red(int p) { return p >> 5; }
+static int green(int p) { return (p >> 2) & 7; }
+static int blue(int p) { return p & 3; }
+static int rgb(int r, int g, int b) { return r << 5 | g << 2 | b; }
+static int clamp(int v, int max) { return v < 0 ? 0 : (v > max ? max : v); }
+
+static int add(int a, int b)
+{
+  return rgb(clamp(red(a) + red(b), 7), clamp(green(a) + green(b), 7), clamp(blue(a) + blue(b), 3));
+}
+
+static int sub(int a, int b)
+{
+  return rgb(clamp(red(a) - red(b), 7), clamp(green(a) - green(b), 7), clamp(blue(a) - blue(b), 3));
+}
+
+static int blend(int a, int b)
+{
+  return rgb((red(a) + red(b))/2, (green(a) + green(b))/2, (blue(a) + blue(b))/2);
+}
+
+static int scale(int a, int s)
+{
+  s = s > 32 ? 32 : s;
+  return rgb(red(a)*s/32, green(a)*s/32, blue(a)*s/32);
+}
+
+static uint32_t seed = 5;
+static int rnd(int n)
+{
+  seed = seed*1103515245 + 12345;
+  return (int)((seed >> 8) % n);
+}
+
+static uint32_t rnd32()
+{
+  return (uint32_t)rnd(1 << 16) << 16 | rnd(1 << 16);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Checks
+
+// Every pair of pixels in every byte of the word, other bytes random so
+// carries and borrows from them would show
+static void check_words()
+{
+  for (int a = 0; a < 256; a++)
+  {
+    for (int b = 0; b < 256; b++)
+    {
+      for (int byte = 0; byte < 4; byte++)
+      {
+        int shift = 8*byte;
+        uint32_t mask = 0xFFu << shift;
+        uint32_t wa = (rnd32() & ~mask) | (uint32_t)a << shift;
+        uint32_t wb = (rnd32() & ~mask) | (uint32_t)b << shift;
+        int got;
+
+        got = (ESP_8_BIT_add332(wa, wb) >> shift) & 0xFF;
+        CHECK(got == add(a, b), "add %02X %02X byte %d: %02X", a, b, byte, got);
+        got = (ESP_8_BIT_sub332(wa, wb) >> shift) & 0xFF;
+        CHECK(got == sub(a, b), "sub %02X %02X byte %d: %02X", a, b, byte, got);
+        got = (ESP_8_BIT_blend332(wa, wb) >> shift) & 0xFF;
+        CHECK(got == blend(a, b), "blend %02X %02X byte %d: %02X", a, b, byte, got);
+        got = (ESP_8_BIT_keyMask332(wa, b*0x01010101u) >> shift) & 0xFF;
+        CHECK(got == (a == b ? 0 : 0xFF), "key %02X %02X byte %d: %02X", a, b, byte, got);
+        got = (ESP_8_BIT_scale332(wa, b) >> shift) & 0xFF;
+        CHECK(got == scale(a, b), "scale %02X by %d byte %d: %02X", a, b, byte, got);
+      }
+    }
+  }
+}
+
+// Rows at every alignment of source and destination, short and long
+static void check_rows()
+{
+  static uint8_t dst[300];
+  static uint8_t src[300];
+  static uint8_t expected[300];
+
+  for (int t = 0; t < 20000; t++)
+  {
+    int offset = rnd(4);
+    int n = rnd(64) + (rnd(4) ? 0 : rnd(200));
+    int op = rnd(7);
+    uint8_t color = rnd(256);
+    int s = rnd(40);
+    for (int i = 0; i < 300; i++)
+    {
+      dst[i] = expected[i] = rnd(256);
+      src[i] = rnd(4) ? rnd(256) : color;
+    }
+    uint8_t* d = dst + offset;
+    uint8_t* e = expected + offset;
+    const uint8_t* sp = src + rnd(4);
+
+    switch (op)
+    {
+      case 0:
+        ESP_8_BIT_addSaturate(d, sp, n);
+        for (int i = 0; i < n; i++) e[i] = add(e[i], sp[i]);
+        break;
+      case 1:
+        ESP_8_BIT_subSaturate(d, sp, n);
+        for (int i = 0; i < n; i++) e[i] = sub(e[i], sp[i]);
+        break;
+      case 2:
+        ESP_8_BIT_blend(d, sp, n);
+        for (int i = 0; i < n; i++) e[i] = blend(e[i], sp[i]);
+        break;
+      case 3:
+        ESP_8_BIT_scale(d, n, s);
+        for (int i = 0; i < n; i++) e[i] = scale(e[i], s);
+        break;
+      case 4:
+        ESP_8_BIT_composeKey(d, sp, n, color);
+        for (int i = 0; i < n; i++) if (sp[i] != color) e[i] = sp[i];
+        break;
+      case 5:
+        ESP_8_BIT_addColor(d, color, n);
+        for (int i = 0; i < n; i++) e[i] = add(e[i], color);
+        break;
+      case 6:
+        ESP_8_BIT_subColor(d, color, n);
+        for (int i = 0; i < n; i++) e[i] = sub(e[i], color);
+        break;
+    }
+    CHECK(0 == memcmp(dst, expected, sizeof(dst)), "row op %d at offset %d, %d pixels", op, offset, n);
+  }
+}
+
+int main()
+{
+  check_words();
+  check_rows();
+  return host_result("test_pixelops");
+}
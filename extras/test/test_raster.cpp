@@ -0,0 +1,54 @@
+/*
+
+Raster callbacks on interlaced video: lines count from the first active line
+of each field, so callbacks run once per field.
+
+*/
+
+#include "host.h"
+#include "ESP_8_BIT_composite.h"
+
+static int calls[320];
+
+static void IRAM_ATTR count_line(int line, void* arg)
+{
+  calls[line]++;
+  CHECK(arg == &calls[line], "line %d got wrong arg", line);
+}
+
+static void check_calls(ESP_8_BIT_composite& video, const int* lines, const int* expected, int count)
+{
+  for (int n = 0; n < count; n++)
+  {
+    video.setRasterCallback(lines[n], count_line, &calls[lines[n]]);
+  }
+
+  // Callbacks apply at the next vertical blank
+  host_lines(_line_count);
+  memset(calls, 0, sizeof(calls));
+  host_lines(_line_count);
+  for (int n = 0; n < count; n++)
+  {
+    CHECK(calls[lines[n]] == expected[n], "line %d called %d times, expected %d",
+      lines[n], calls[lines[n]], expected[n]);
+  }
+}
+
+int main()
+{
+  // Kept for the life of the program, as ESP_8_BIT_GFX keeps its own
+  ESP_8_BIT_composite& video = *new ESP_8_BIT_composite(true);
+  video.setInterlace(true);
+  video.begin();
+
+  // Lines past the first field are not raster lines
+  video.setRasterCallback(263, count_line, NULL);
+  video.setRasterCallback(300, count_line, NULL);
+
+  const int lines[] = { 0, 100, 239, 261, 262 };
+  const int expected[] = { 2, 2, 2, 2, 1 };
+  check_calls(video, lines, expected, 5);
+  CHECK(0 == calls[263] && 0 == calls[300], "out of range lines called");
+
+  return host_result("test_raster");
+}
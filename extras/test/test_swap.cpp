@@ -0,0 +1,66 @@
+/*
+
+Whole frame double buffering: ESP_8_BIT_GFX::waitForFrame() returns once the
+buffers swapped at vertical blank, and drawing then goes into the new back
+buffer for the rest of the frame, never into the one on screen.
+
+*/
+
+#include "host.h"
+
+// Included rather than linked to reach the front and back buffers
+#include "ESP_8_BIT_composite.cpp"
+#include "ESP_8_BIT_GFX.h"
+
+static int waits;
+
+// Stands in for the video interrupt while waitForFrame() waits
+static void wait_hook()
+{
+  waits++;
+  host_lines(1);
+}
+
+int main()
+{
+  ESP_8_BIT_GFX gfx(true, 8);
+  gfx.begin();
+  host_wait_hook = wait_hook;
+
+  for (int copy = 0; copy < 2; copy++)
+  {
+    gfx.copyAfterSwap = copy;
+    for (int frame = 0; frame < 3; frame++)
+    {
+      uint8_t color = 0x10*copy + frame + 1;
+      gfx.fillScreen(color);
+      uint8_t** drawn = _backBuffer;
+      uint32_t swaps = gfx.getComposite()->getBufferSwapCount();
+
+      // Start partway into a frame, as a sketch would
+      host_lines(100);
+      waits = 0;
+      gfx.waitForFrame();
+      CHECK(gfx.getComposite()->getBufferSwapCount() == swaps + 1, "no swap, %d waits", waits);
+      CHECK(_lines == drawn, "drawn buffer not on screen");
+      CHECK(_lines[120][128] == color, "screen shows %02X", _lines[120][128]);
+
+      // Drawing later in the frame, after another vertical blank
+      host_lines(600);
+      gfx.drawPixel(10, 20, 0xE0);
+      gfx.fillRect(100, 100, 8, 8, 0x03);
+      gfx.drawFastHLine(0, 200, 256, 0x1C);
+      CHECK(_backBuffer[20][10] == 0xE0, "pixel not in back buffer");
+      CHECK(_backBuffer[104][104] == 0x03, "rectangle not in back buffer");
+      CHECK(_backBuffer[200][50] == 0x1C, "line not in back buffer");
+      CHECK(_lines[20][10] == color && _lines[104][104] == color && _lines[200][50] == color,
+        "frame %d drew into front buffer", frame);
+      if (copy)
+      {
+        CHECK(_backBuffer[120][128] == color, "copyAfterSwap did not copy");
+      }
+    }
+  }
+
+  return host_result("test_swap");
+}
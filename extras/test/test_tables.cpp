@@ -0,0 +1,139 @@
+/*
+
+Signal timing and palette tables generated at compile time must equal what
+the library computed at runtime before they were made constexpr. The runtime
+math below is video_init() and pal_init() as they were, float and all.
+
+The stock NTSC and PAL RGB332 tables are hand tuned data rather than output
+of a formula, so generated RGB332 palettes can only be held to within one DAC
+step of them (static_assert in ESP_8_BIT_composite.cpp). Here the generator
+is checked exactly against the same YIQ/YUV math done at runtime with libm.
+
+*/
+
+#include "host.h"
+
+// Included rather than linked to reach its file scope tables
+#include "ESP_8_BIT_composite.cpp"
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Runtime timing math formerly in video_init() and pal_init()
+
+static float old_sample_rate;
+static int old_samples_per_cc;
+
+static int old_usec(float us)
+{
+  uint32_t r = (uint32_t)(us*old_sample_rate);
+  return ((r + old_samples_per_cc)/(old_samples_per_cc << 1))*(old_samples_per_cc << 1);
+}
+
+static void check_ntsc_timing(const video_timing& t, int samples_per_cc)
+{
+  old_samples_per_cc = samples_per_cc;
+  old_sample_rate = 315.0/88 * samples_per_cc;
+  CHECK(t.samples_per_cc == samples_per_cc, "%d", t.samples_per_cc);
+  CHECK(t.line_width == NTSC_COLOR_CLOCKS_PER_SCANLINE*samples_per_cc, "%d", t.line_width);
+  CHECK(t.line_count == NTSC_LINES, "%d", t.line_count);
+  CHECK(t.hsync_long == old_usec(63.555-4.7), "%d", t.hsync_long);
+  CHECK(t.active_start == old_usec(samples_per_cc == 4 ? 10 : 10.5), "%d", t.active_start);
+  CHECK(t.hsync == old_usec(4.7), "%d", t.hsync);
+}
+
+static void check_pal_timing(const video_timing& t)
+{
+  int cc_width = 4;
+  old_samples_per_cc = cc_width;
+  old_sample_rate = PAL_FREQUENCY*cc_width/1000000.0;
+  CHECK(t.samples_per_cc == cc_width, "%d", t.samples_per_cc);
+  CHECK(t.line_width == PAL_COLOR_CLOCKS_PER_SCANLINE*cc_width, "%d", t.line_width);
+  CHECK(t.line_count == PAL_LINES, "%d", t.line_count);
+  CHECK(t.hsync_short == old_usec(2), "%d", t.hsync_short);
+  CHECK(t.hsync_long == old_usec(30), "%d", t.hsync_long);
+  CHECK(t.hsync == old_usec(4.7), "%d", t.hsync);
+  CHECK(t.burst_start == old_usec(5.6), "%d", t.burst_start);
+  CHECK(t.burst_width == ((int)(10*cc_width + 4) & 0xFFFE), "%d", t.burst_width);
+  CHECK(t.active_start == old_usec(10.4), "%d", t.active_start);
+}
+
+static void check_pal_burst()
+{
+  int cc_width = 4;
+  float phase = 2*M_PI/2;
+  for (int i = 0; i < PAL_BURST_WIDTH; i++)
+  {
+    int16_t burst0 = BLANKING_LEVEL + sin(phase + 3*M_PI/4) * BLANKING_LEVEL/1.5;
+    int16_t burst1 = BLANKING_LEVEL + sin(phase - 3*M_PI/4) * BLANKING_LEVEL/1.5;
+    CHECK(_burst0.sample[i] == burst0, "burst0[%d] %d vs %d", i, _burst0.sample[i], burst0);
+    CHECK(_burst1.sample[i] == burst1, "burst1[%d] %d vs %d", i, _burst1.sample[i], burst1);
+    phase += 2*M_PI/cc_width;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+//  Palette generator against the same formulas evaluated with libm
+
+static uint32_t runtime_level(double v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : (uint32_t)v);
+}
+
+static uint32_t runtime_ntsc_entry(int index, int samplesPerCC)
+{
+  double r = (index >> 5)/7.0, g = ((index >> 2) & 7)/7.0, b = (index & 3)/3.0;
+  double y = 0.299*r + 0.587*g + 0.114*b;
+  double i = 0.596*r - 0.274*g - 0.322*b;
+  double q = 0.211*r - 0.523*g + 0.312*b;
+  uint32_t entry = 0;
+  for (int t = 0; t < 4; t++)
+  {
+    double phase = (t*360.0/samplesPerCC + ESP_8_BIT_NTSC_PHASE)*M_PI/180;
+    entry = (entry << 8) | runtime_level(ESP_8_BIT_NTSC_BLACK +
+      (ESP_8_BIT_NTSC_WHITE - ESP_8_BIT_NTSC_BLACK)*(y + ESP_8_BIT_NTSC_CHROMA*(i*cos(phase) + q*sin(phase))));
+  }
+  return entry;
+}
+
+static uint32_t runtime_pal_entry(int index)
+{
+  double r = ((index & 0xFF) >> 5)/7.0, g = ((index >> 2) & 7)/7.0, b = (index & 3)/3.0;
+  double y = 0.299*r + 0.587*g + 0.114*b;
+  double u = 0.492*(b - y);
+  double v = (index >= 256 ? -0.877 : 0.877)*(r - y);
+  uint32_t entry = 0;
+  for (int t = 0; t < 4; t++)
+  {
+    double phase = (t*90.0 + ESP_8_BIT_PAL_PHASE)*M_PI/180;
+    entry = (entry << 8) | runtime_level(ESP_8_BIT_PAL_BLACK +
+      (ESP_8_BIT_PAL_WHITE - ESP_8_BIT_PAL_BLACK)*(y + ESP_8_BIT_PAL_CHROMA*(u*sin(phase) + v*cos(phase))));
+  }
+  return entry;
+}
+
+static void check_palettes()
+{
+  for (int i = 0; i < 256; i++)
+  {
+    CHECK(ntsc_RGB332_generated.entry[i] == runtime_ntsc_entry(i, 4), "NTSC %02x: %08x vs %08x",
+      i, ntsc_RGB332_generated.entry[i], runtime_ntsc_entry(i, 4));
+    CHECK(ntsc3_RGB332.entry[i] == runtime_ntsc_entry(i, 3), "NTSC 3x %02x: %08x vs %08x",
+      i, ntsc3_RGB332.entry[i], runtime_ntsc_entry(i, 3));
+  }
+  for (int i = 0; i < 512; i++)
+  {
+    CHECK(pal_yuyv_generated.entry[i] == runtime_pal_entry(i), "PAL %03x: %08x vs %08x",
+      i, pal_yuyv_generated.entry[i], runtime_pal_entry(i));
+  }
+}
+
+int main()
+{
+  check_ntsc_timing(_ntsc3_timing, 3);
+  check_ntsc_timing(_ntsc4_timing, 4);
+  check_pal_timing(_pal4_timing);
+  check_pal_burst();
+  check_palettes();
+  return host_result("test_tables");
+}